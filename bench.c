@@ -1,18 +1,28 @@
 // Copyright (c) 2025 Stateless Limited
 // SPDX-License-Identifier: MIT
 
+#define _GNU_SOURCE // clock_gettime under -std=c11, sched/syscall for the NUMA rows
+
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <unistd.h>
+#define UUIDV47_ENABLE_THREADS 1
+#define UUIDV47_ENABLE_NUMA 1
+#define UUIDV47_ENABLE_MMAP 1
 #include "uuidv47.h"
 
 #ifndef BENCH_DEFAULT_ITERS
 #define BENCH_DEFAULT_ITERS 2000000u
 #endif
 
+#ifndef BENCH_BATCH
+#define BENCH_BATCH 1024u
+#endif
+
 static inline uint64_t ns_now(void)
 {
 #if defined(CLOCK_MONOTONIC)
@@ -64,6 +74,7 @@ typedef struct
   uint32_t iters;
   int warmup_rounds;
   int measured_rounds;
+  unsigned threads; // max workers for the parallel table, 0 = online CPUs
   bool quiet;
 } cfg_t;
 
@@ -72,6 +83,7 @@ static void parse_args(int argc, char **argv, cfg_t *c)
   c->iters = BENCH_DEFAULT_ITERS;
   c->warmup_rounds = 1;
   c->measured_rounds = 3;
+  c->threads = 0;
   c->quiet = false;
   for (int i = 1; i < argc; i++)
   {
@@ -87,13 +99,17 @@ static void parse_args(int argc, char **argv, cfg_t *c)
     {
       c->measured_rounds = atoi(argv[++i]);
     }
+    else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+    {
+      c->threads = (unsigned)strtoul(argv[++i], NULL, 10);
+    }
     else if (strcmp(argv[i], "-q") == 0)
     {
       c->quiet = true;
     }
     else if (strcmp(argv[i], "-h") == 0)
     {
-      fprintf(stderr, "Usage: %s [-n iters] [-w warmup] [-r rounds] [-q]\n", argv[0]);
+      fprintf(stderr, "Usage: %s [-n iters] [-w warmup] [-r rounds] [-t threads] [-q]\n", argv[0]);
       exit(0);
     }
   }
@@ -204,22 +220,1210 @@ static double bench_siphash_only(const cfg_t *c, uuidv47_key_t key, uint64_t *ou
   return (double)best_ns_per_op;
 }
 
-int main(int argc, char **argv)
+static double bench_siphash24_10(const cfg_t *c, uuidv47_key_t key, uint64_t *out_guard)
 {
-  cfg_t cfg;
-  parse_args(argc, argv, &cfg);
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
 
-  // Fixed demo key (replace in prod)
-  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t seed = (uint64_t)ns_now() ^ 0xbb67ae8584caa73bULL ^ (uint64_t)(round * 3 + 1);
 
-  if (!cfg.quiet)
+    uint64_t start = ns_now();
+    for (uint32_t i = 0; i < c->iters; i++)
+    {
+      // Synthesize the exact 10-byte message shape
+      uuid128_t u7;
+      uint64_t ts = (xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL);
+      uint16_t ra = (uint16_t)(xorshift64star(&seed) & 0x0FFFu);
+      uint64_t rb = (xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+      craft_v7(&u7, ts, ra, rb);
+
+      uint64_t m0, m1;
+      sip_words_from_uuid(&u7, &m0, &m1);
+      uint64_t out = siphash24_10(m0, m1, key.k0, key.k1);
+      guard ^= out;
+    }
+    uint64_t end = ns_now();
+    uint64_t ns = end - start;
+    double ns_per_op = (double)ns / (double)c->iters;
+
+    if (round >= 0)
+    {
+      if (!c->quiet)
+      {
+        printf("[siphash24_10] round %d: %.2f ns/op, %.1f Mops/s\n",
+               round + 1, ns_per_op, 1000.0 / ns_per_op);
+      }
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Array kernels: one call transforms `n` IDs from `in` into `out`.
+typedef void (*array_fn)(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key);
+
+static void scalar_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = uuidv47_encode_v4facade(in[i], key);
+}
+
+static void scalar_decode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = uuidv47_decode_v4facade(in[i], key);
+}
+
+// per-ID calls through a precomputed key context (set up in main)
+static uuidv47_ctx_t bench_ctx, bench_ctx13, bench_ctx_aes;
+
+static void ctx_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  const uuidv47_ctx_t c = bench_ctx; // out[] stores may alias a global ctx
+  for (size_t i = 0; i < n; i++)
+    out[i] = uuidv47_ctx_encode(&c, &in[i]);
+}
+
+static void ctx_decode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  const uuidv47_ctx_t c = bench_ctx; // out[] stores may alias a global ctx
+  for (size_t i = 0; i < n; i++)
+    out[i] = uuidv47_ctx_decode(&c, &in[i]);
+}
+
+// batch path pinned to the portable 4-stream scalar kernel
+static void x4_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_transform_batch(&bench_ctx, in, out, n, 4, UUIDV47_SIMD_SCALAR);
+}
+
+static void x4_decode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_transform_batch(&bench_ctx, in, out, n, 7, UUIDV47_SIMD_SCALAR);
+}
+
+// encode+decode over a fixed array of BENCH_BATCH IDs; ns/op is per ID round trip
+static double bench_array_roundtrip(const cfg_t *c, const char *label, array_fn enc, array_fn dec,
+                                    uuidv47_key_t key, uint64_t *out_guard)
+{
+  static uuid128_t v7[BENCH_BATCH], facade[BENCH_BATCH], back[BENCH_BATCH];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x3c6ef372fe94f82bULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
   {
-    printf("iters=%u, warmup=%d, rounds=%d\n", cfg.iters, cfg.warmup_rounds, cfg.measured_rounds);
+    uint64_t ts = (xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL);
+    uint16_t ra = (uint16_t)(xorshift64star(&seed) & 0x0FFFu);
+    uint64_t rb = (xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+    craft_v7(&v7[i], ts, ra, rb);
+  }
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      enc(v7, facade, BENCH_BATCH, key);
+      dec(facade, back, BENCH_BATCH, key);
+      guard ^= ((uint64_t)facade[r % BENCH_BATCH].b[0] << 0) ^ ((uint64_t)back[r % BENCH_BATCH].b[10] << 16);
+    }
+    uint64_t end = ns_now();
+    if (memcmp(v7, back, sizeof(v7)) != 0)
+    {
+      fprintf(stderr, "%s: round-trip mismatch\n", label);
+      exit(2);
+    }
+    double ns_per_op = (double)(end - start) / ((double)reps * BENCH_BATCH);
+
+    if (round >= 0)
+    {
+      if (!c->quiet)
+      {
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n",
+               label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      }
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
   }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+static void bitsliced_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_ctx_encode_batch_bitsliced(&bench_ctx, in, out, n);
+}
+
+static void best_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_ctx_encode_batch(&bench_ctx, in, out, n);
+}
+
+static void best13_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_ctx_encode_batch(&bench_ctx13, in, out, n);
+}
+
+static void aes_encode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_ctx_encode_batch(&bench_ctx_aes, in, out, n);
+}
 
+static void aes_decode_array(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  (void)key;
+  uuidv47_ctx_decode_batch(&bench_ctx_aes, in, out, n);
+}
+
+// In-place round-trip over a BENCH_BATCH-ID array (no separate output array)
+static double bench_inplace(const cfg_t *c, uint64_t *out_guard)
+{
+  static uuid128_t ids[BENCH_BATCH];
+  uint64_t bad[BENCH_BATCH / 64];
+  uint64_t best_ns_per_op = UINT64_MAX;
   uint64_t guard = 0;
-  double ns_encode_decode = bench_encode_decode(&cfg, key, &guard);
-  double ns_siphash = bench_siphash_only(&cfg, key, &guard);
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x9b05688c2b3e6c1fULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&ids[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      size_t ok = uuidv47_encode_inplace(ids, BENCH_BATCH, &bench_ctx, bad);
+      ok += uuidv47_decode_inplace(ids, BENCH_BATCH, &bench_ctx, bad);
+      if (ok != 2 * BENCH_BATCH)
+      {
+        fprintf(stderr, "array inplace: version check failed\n");
+        exit(2);
+      }
+      guard += ids[r % BENCH_BATCH].b[r & 15];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[array inplace] round %d: %.2f ns/op, %.1f Mops/s\n", round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Round-trip over the ID field of BENCH_BATCH 64-byte rows: strided in place,
+// or copied out to a uuid128_t array, batch-transformed and copied back
+typedef struct
+{
+  uint64_t key;
+  uuid128_t id;
+  uint8_t payload[40];
+} bench_row_t;
+
+static double bench_rows(const cfg_t *c, const char *label, bool strided, uint64_t *out_guard)
+{
+  static bench_row_t rows[BENCH_BATCH];
+  static uuid128_t tmp[BENCH_BATCH];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x5be0cd19137e2179ULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+  {
+    rows[i].key = i;
+    craft_v7(&rows[i].id, xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  }
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      if (strided)
+      {
+        uuidv47_encode_strided(rows, BENCH_BATCH, sizeof(bench_row_t), offsetof(bench_row_t, id), &bench_ctx, NULL);
+        uuidv47_decode_strided(rows, BENCH_BATCH, sizeof(bench_row_t), offsetof(bench_row_t, id), &bench_ctx, NULL);
+      }
+      else
+      {
+        for (int dir = 0; dir < 2; dir++)
+        {
+          for (uint32_t i = 0; i < BENCH_BATCH; i++)
+            tmp[i] = rows[i].id;
+          if (dir == 0)
+            uuidv47_ctx_encode_batch(&bench_ctx, tmp, tmp, BENCH_BATCH);
+          else
+            uuidv47_ctx_decode_batch(&bench_ctx, tmp, tmp, BENCH_BATCH);
+          for (uint32_t i = 0; i < BENCH_BATCH; i++)
+            rows[i].id = tmp[i];
+        }
+      }
+      guard += rows[r % BENCH_BATCH].id.b[r & 15];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Round-trip on BENCH_BATCH IDs held as SoA columns
+static double bench_soa(const cfg_t *c, uint64_t *out_guard)
+{
+  static uuid128_t ids[BENCH_BATCH];
+  static uint64_t ts[BENCH_BATCH], lo[BENCH_BATCH];
+  static uint16_t hi[BENCH_BATCH];
+  const uuidv47_soa_t soa = {ts, lo, hi};
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x1f83d9abfb41bd6bULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&ids[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  uuidv47_soa_from_uuids(ids, BENCH_BATCH, &soa);
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      uuidv47_soa_encode(&bench_ctx, &soa, BENCH_BATCH);
+      uuidv47_soa_decode(&bench_ctx, &soa, BENCH_BATCH);
+      guard += ts[r % BENCH_BATCH];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[array soa] round %d: %.2f ns/op, %.1f Mops/s\n", round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Creation time of BENCH_BATCH façades: full decode + rd48be per ID, the
+// timestamp-only call per ID, or the batch call
+static double bench_facade_ts(const cfg_t *c, const char *label, int mode, uint64_t *out_guard)
+{
+  static uuid128_t fac[BENCH_BATCH];
+  static uint64_t ts[BENCH_BATCH];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0xbe5466cf34e90c6cULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&fac[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  uuidv47_ctx_encode_batch(&bench_ctx, fac, fac, BENCH_BATCH);
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      if (mode == 0)
+        for (uint32_t i = 0; i < BENCH_BATCH; i++)
+        {
+          uuid128_t v7 = uuidv47_ctx_decode(&bench_ctx, &fac[i]);
+          ts[i] = rd48be(v7.b);
+        }
+      else if (mode == 1)
+        for (uint32_t i = 0; i < BENCH_BATCH; i++)
+          ts[i] = uuidv47_facade_timestamp_ms(&fac[i], &bench_ctx);
+      else
+        uuidv47_facade_timestamps_ms(fac, BENCH_BATCH, &bench_ctx, ts);
+      guard += ts[r % BENCH_BATCH];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// String parsing over BENCH_BATCH canonical strings
+// Time-range scan over BENCH_BATCH v7 IDs spread over ~17 minutes: a plain
+// rd48be loop, the bitmap and index-list filters, and a 1-second histogram.
+// Sub-nanosecond per ID, so the best is kept unrounded.
+static double bench_time_scan(const cfg_t *c, const char *label, int mode, uint64_t *out_guard)
+{
+  static uuid128_t ids[BENCH_BATCH];
+  static uint64_t bitmap[(BENCH_BATCH + 63) / 64];
+  static size_t idx[BENCH_BATCH];
+  static uint64_t counts[1024];
+  double best_ns_per_op = 1e30;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  const uint64_t base = 0x0190a1b2c3d4ULL;
+  uint64_t seed = (uint64_t)ns_now() ^ 0x2545f4914f6cdd1dULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&ids[i], base + (xorshift64star(&seed) & 0xFFFFFu), (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  const uint64_t t0 = base + 0x40000, t1 = base + 0xC0000;
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      size_t hits = 0;
+      if (mode == 0)
+      {
+        memset(bitmap, 0, sizeof bitmap);
+        for (size_t i = 0; i < BENCH_BATCH; i++)
+        {
+          uint64_t ts = rd48be(ids[i].b);
+          bool in = ts >= t0 && ts < t1;
+          bitmap[i / 64] |= (uint64_t)in << (i % 64);
+          hits += in;
+        }
+      }
+      else if (mode == 1)
+        hits = uuidv47_time_filter_bitmap(ids, BENCH_BATCH, t0, t1, bitmap);
+      else if (mode == 2)
+        hits = uuidv47_time_filter_index(ids, BENCH_BATCH, t0, t1, idx);
+      else
+        hits = uuidv47_time_histogram(ids, BENCH_BATCH, base, 1000, counts, 1024);
+      guard += hits;
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if (ns_per_op < best_ns_per_op)
+        best_ns_per_op = ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard ^ counts[0];
+  return best_ns_per_op;
+}
+
+typedef bool (*parse_fn)(const char *s, uuid128_t *out);
+
+static double bench_parse(const cfg_t *c, const char *label, parse_fn fn, uint64_t *out_guard)
+{
+  static char strs[BENCH_BATCH][37];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x510e527fade682d1ULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+  {
+    uuid128_t u;
+    craft_v7(&u, xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+    uuid_format(&u, strs[i]);
+  }
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      for (uint32_t i = 0; i < BENCH_BATCH; i++)
+      {
+        uuid128_t u;
+        if (!fn(strs[i], &u))
+        {
+          fprintf(stderr, "%s: parse failed\n", label);
+          exit(2);
+        }
+        guard += u.b[(i + r) & 15];
+      }
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Newline-delimited text, BENCH_BATCH lines encoded then decoded in place
+static double bench_text_lines(const cfg_t *c, uint64_t *out_guard)
+{
+  static char text[BENCH_BATCH * 37];
+  static uint64_t err[(BENCH_BATCH + 63) / 64];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x1f83d9abfb41bd6bULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+  {
+    uuid128_t u;
+    craft_v7(&u, xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+    uuid_format36(&u, &text[i * 37], false);
+    text[i * 37 + 36] = '\n';
+  }
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      size_t lines;
+      uuidv47_encode_lines(&bench_ctx, text, sizeof(text), text, err, BENCH_BATCH, &lines);
+      uuidv47_decode_lines(&bench_ctx, text, sizeof(text), text, err, BENCH_BATCH, &lines);
+      guard += (uint8_t)text[r % sizeof(text)] + err[0];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[text lines] round %d: %.2f ns/op, %.1f Mops/s\n", round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// v7 string -> façade string -> v7 string over BENCH_BATCH strings, either via
+// parse + ctx encode/decode + format or the fused string transforms
+static double bench_str_roundtrip(const cfg_t *c, const char *label, bool fused, uint64_t *out_guard)
+{
+  static char strs[BENCH_BATCH][36];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x3c6ef372fe94f82bULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+  {
+    uuid128_t u;
+    craft_v7(&u, xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+    uuid_format36(&u, strs[i], false);
+  }
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      for (uint32_t i = 0; i < BENCH_BATCH; i++)
+      {
+        bool ok;
+        if (fused)
+          ok = uuidv47_v7_str_to_facade_str(&bench_ctx, strs[i], strs[i]) &&
+               uuidv47_facade_str_to_v7_str(&bench_ctx, strs[i], strs[i]);
+        else
+        {
+          uuid128_t u;
+          ok = uuid_parse(strs[i], &u);
+          u = uuidv47_ctx_encode(&bench_ctx, &u);
+          uuid_format36(&u, strs[i], false);
+          ok = ok && uuid_parse(strs[i], &u);
+          u = uuidv47_ctx_decode(&bench_ctx, &u);
+          uuid_format36(&u, strs[i], false);
+        }
+        if (!ok)
+        {
+          fprintf(stderr, "%s: transform failed\n", label);
+          exit(2);
+        }
+      }
+      guard += (uint8_t)strs[r % BENCH_BATCH][r % 36];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// Compact encodings: format then parse back, BENCH_BATCH IDs
+typedef void (*compact_format_fn)(const uuid128_t *u, char *out);
+typedef bool (*compact_parse_fn)(const char *s, uuid128_t *out);
+
+static double bench_compact(const cfg_t *c, const char *label, compact_format_fn fmt, compact_parse_fn parse,
+                            uint64_t *out_guard)
+{
+  static uuid128_t ids[BENCH_BATCH];
+  static char strs[BENCH_BATCH][32];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0xa54ff53a5f1d36f1ULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&ids[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      for (uint32_t i = 0; i < BENCH_BATCH; i++)
+      {
+        fmt(&ids[i], strs[i]);
+        if (!parse(strs[i], &ids[i]))
+        {
+          fprintf(stderr, "%s: parse failed\n", label);
+          exit(2);
+        }
+      }
+      guard += ids[r % BENCH_BATCH].b[r & 15];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+static bool parse_any_canonical(const char *s, uuid128_t *out)
+{
+  return uuid_parse_any(s, 36, out) == UUID_PARSE_OK;
+}
+
+// Formatting BENCH_BATCH IDs into a 36-byte buffer each
+typedef void (*format_fn)(const uuid128_t *u, char out[36], bool upper);
+
+static double bench_format(const cfg_t *c, const char *label, format_fn fn, uint64_t *out_guard)
+{
+  static uuid128_t ids[BENCH_BATCH];
+  static char strs[BENCH_BATCH][36];
+  uint64_t best_ns_per_op = UINT64_MAX;
+  uint64_t guard = 0;
+  uint32_t reps = c->iters / BENCH_BATCH ? c->iters / BENCH_BATCH : 1u;
+
+  uint64_t seed = (uint64_t)ns_now() ^ 0x9b05688c2b3e6c1fULL;
+  for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    craft_v7(&ids[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    for (uint32_t r = 0; r < reps; r++)
+    {
+      for (uint32_t i = 0; i < BENCH_BATCH; i++)
+        fn(&ids[i], strs[i], false);
+      guard += (uint8_t)strs[r % BENCH_BATCH][r % 36];
+    }
+    double ns_per_op = (double)(ns_now() - start) / ((double)reps * BENCH_BATCH);
+    if (round >= 0)
+    {
+      if (!c->quiet)
+        printf("[%s] round %d: %.2f ns/op, %.1f Mops/s\n", label, round + 1, ns_per_op, 1000.0 / ns_per_op);
+      if ((uint64_t)ns_per_op < best_ns_per_op)
+        best_ns_per_op = (uint64_t)ns_per_op;
+    }
+    else if (!c->quiet)
+    {
+      printf("[warmup] %.2f ns/op\n", ns_per_op);
+    }
+  }
+  *out_guard ^= guard;
+  return (double)best_ns_per_op;
+}
+
+// encode-only ns/ID per kernel as the batch grows past L1/L2
+static void bench_batch_sizes(const cfg_t *c, uuidv47_key_t key, uint64_t *out_guard)
+{
+  static const size_t sizes[] = {64, 256, 1024, 16384, 262144};
+  static const struct
+  {
+    const char *name;
+    array_fn fn;
+  } kernels[] = {
+      {"ctx", ctx_encode_array},
+      {"x4", x4_encode_array},
+      {"best", best_encode_array},
+      {"best 1-3", best13_encode_array},
+      {"aes", aes_encode_array},
+      {"bitsliced", bitsliced_encode_array},
+  };
+  const size_t max_n = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+  uuid128_t *in = malloc(max_n * sizeof(uuid128_t));
+  uuid128_t *out = malloc(max_n * sizeof(uuid128_t));
+  if (!in || !out)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0xa54ff53a5f1d36f1ULL;
+  for (size_t i = 0; i < max_n; i++)
+  {
+    uint64_t ts = (xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL);
+    uint16_t ra = (uint16_t)(xorshift64star(&seed) & 0x0FFFu);
+    uint64_t rb = (xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+    craft_v7(&in[i], ts, ra, rb);
+  }
+
+  printf("== encode ns/ID by batch size ==\n%-10s", "batch");
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    printf(" %10s", kernels[k].name);
+  printf("\n");
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    size_t n = sizes[s];
+    size_t reps = c->iters / n ? c->iters / n : 1u;
+    printf("%-10zu", n);
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+      double best = 1e300;
+      for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+      {
+        uint64_t start = ns_now();
+        for (size_t r = 0; r < reps; r++)
+          kernels[k].fn(in, out, n, key);
+        double ns_per_op = (double)(ns_now() - start) / ((double)reps * (double)n);
+        *out_guard ^= out[n - 1].b[0];
+        if (round >= 0 && ns_per_op < best)
+          best = ns_per_op;
+      }
+      printf(" %10.2f", best);
+    }
+    printf("\n");
+  }
+  free(in);
+  free(out);
+}
+
+// Parallel encode of a large array (well past LLC) for 1, 2, 4, ... workers:
+// aggregate throughput plus the slowest and fastest worker
+static int cmp_uuid_memcmp(const void *a, const void *b)
+{
+  return memcmp(a, b, sizeof(uuid128_t));
+}
+
+// Array size for the whole-array sections: -n scaled by mul/div (the defaults
+// below are for -n 2000000), at least one batch.
+static size_t bench_size(const cfg_t *c, size_t mul, size_t div)
+{
+  size_t n = (size_t)c->iters * mul / div;
+  return n > BENCH_BATCH ? n : BENCH_BATCH;
+}
+
+// Sorting -n v7 IDs (2M by default) spread over one hour, input order
+// random: qsort + memcmp against the radix sort, its index variant and the
+// parallel sort. Each round re-copies the unsorted input (not timed).
+static void bench_sort(const cfg_t *c, uint64_t *out_guard)
+{
+  const size_t n = bench_size(c, 1, 1);
+  uuid128_t *in = malloc(n * sizeof(uuid128_t)), *work = malloc(n * sizeof(uuid128_t));
+  uuid128_t *scratch = malloc(n * sizeof(uuid128_t));
+  size_t *perm = malloc(n * sizeof(size_t));
+  uuidv47_sort_ent_t *ents = malloc(2 * n * sizeof(uuidv47_sort_ent_t));
+  if (!in || !work || !scratch || !perm || !ents)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0x13198a2e03707344ULL;
+  for (size_t i = 0; i < n; i++)
+    craft_v7(&in[i], 0x0190a1b2c3d4ULL + xorshift64star(&seed) % 3600000u, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  memset(scratch, 0, n * sizeof(uuid128_t));
+  memset(ents, 0, 2 * n * sizeof(uuidv47_sort_ent_t));
+
+  printf("== sort, %zu IDs ==\n%-16s %10s %10s\n", n, "method", "ms", "Mids/s");
+  const char *names[4] = {"qsort memcmp", "radix", "radix index", "radix parallel"};
+  for (int m = 0; m < 4; m++)
+  {
+    double best = 1e300;
+    for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+    {
+      memcpy(work, in, n * sizeof(uuid128_t));
+      uint64_t start = ns_now();
+      if (m == 0)
+        qsort(work, n, sizeof(uuid128_t), cmp_uuid_memcmp);
+      else if (m == 1)
+        uuidv47_sort(work, n, scratch);
+      else if (m == 2)
+        uuidv47_sort_index(in, n, perm, ents);
+      else
+        uuidv47_sort_parallel(work, n, scratch, c->threads);
+      double ms = (double)(ns_now() - start) / 1e6;
+      *out_guard ^= m == 2 ? perm[n / 2] : work[n / 2].b[7];
+      if (round >= 0 && ms < best)
+        best = ms;
+    }
+    printf("%-16s %10.1f %10.1f\n", names[m], best, (double)n / best / 1000.0);
+  }
+  free(in);
+  free(work);
+  free(scratch);
+  free(perm);
+  free(ents);
+}
+
+// Point lookups (-n / 2) of random members of a sorted set of 2 * -n v7 IDs
+// (4M, 64 MiB by default) from one day: plain binary search, table-free
+// interpolation, and the radix table.
+static void bench_lookup(const cfg_t *c, uint64_t *out_guard)
+{
+  const size_t n = bench_size(c, 2, 1), q = bench_size(c, 1, 2);
+  uuid128_t *ids = malloc(n * sizeof(uuid128_t)), *keys = malloc(q * sizeof(uuid128_t));
+  size_t *slots = malloc((uuidv47_lookup_slots(n) + 1) * sizeof(size_t));
+  if (!ids || !keys || !slots)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0xa4093822299f31d0ULL;
+  for (size_t i = 0; i < n; i++)
+    craft_v7(&ids[i], 0x0190a1b2c3d4ULL + xorshift64star(&seed) % 86400000u, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  uuid128_t *scratch = malloc(n * sizeof(uuid128_t));
+  if (!scratch)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uuidv47_sort(ids, n, scratch);
+  free(scratch);
+  for (size_t i = 0; i < q; i++)
+    keys[i] = ids[xorshift64star(&seed) % n];
+  uuidv47_lookup_t lk;
+  uint64_t build = ns_now();
+  uuidv47_lookup_init(&lk, ids, n, slots, uuidv47_lookup_slots(n));
+  build = ns_now() - build;
+
+  printf("== lookup, %zu sorted IDs, table build %.1f ms ==\n%-16s %10s\n", n, (double)build / 1e6, "method",
+         "ns/lookup");
+  const char *names[3] = {"binary", "interpolation", "radix table"};
+  for (int m = 0; m < 3; m++)
+  {
+    double best = 1e300;
+    for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+    {
+      size_t sum = 0;
+      uint64_t start = ns_now();
+      for (size_t i = 0; i < q; i++)
+        sum += m == 0   ? uuidv47_binary_lower_bound(ids, 0, n, &keys[i])
+               : m == 1 ? uuidv47_interp_lower_bound(ids, n, &keys[i])
+                        : uuidv47_lookup_lower_bound(&lk, &keys[i]);
+      double ns = (double)(ns_now() - start) / (double)q;
+      *out_guard ^= sum;
+      if (round >= 0 && ns < best)
+        best = ns;
+    }
+    printf("%-16s %10.1f\n", names[m], best);
+  }
+  free(ids);
+  free(keys);
+  free(slots);
+}
+
+// Index file of 2 * -n sorted v7 IDs (4M by default) from one day: write and
+// open time, then -n / 2 point lookups of members (page cache warm) and
+// 1-second range queries.
+static void bench_idxfile(const cfg_t *c, uint64_t *out_guard)
+{
+  const size_t n = bench_size(c, 2, 1), q = bench_size(c, 1, 2);
+  uuid128_t *ids = malloc(n * sizeof(uuid128_t)), *scratch = malloc(n * sizeof(uuid128_t));
+  if (!ids || !scratch)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0x082efa98ec4e6c89ULL;
+  const uint64_t base = 0x0190a1b2c3d4ULL;
+  for (size_t i = 0; i < n; i++)
+    craft_v7(&ids[i], base + xorshift64star(&seed) % 86400000u, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  uuidv47_sort(ids, n, scratch);
+  for (size_t i = 0; i < q; i++)
+    scratch[i] = ids[xorshift64star(&seed) % n];
+
+  char path[] = "/tmp/uuidv47_bench_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+  {
+    perror("mkstemp");
+    exit(2);
+  }
+  close(fd);
+  uint64_t t_write = ns_now();
+  bool ok = uuidv47_idxfile_write(path, ids, n);
+  t_write = ns_now() - t_write;
+  uuidv47_idxfile_t f;
+  uint64_t t_open = ns_now();
+  ok = ok && uuidv47_idxfile_open(&f, path);
+  t_open = ns_now() - t_open;
+  if (!ok)
+  {
+    fprintf(stderr, "index file write/open failed\n");
+    exit(2);
+  }
+
+  double best_find = 1e300, best_range = 1e300;
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    size_t hits = 0, first = 0;
+    uint64_t start = ns_now();
+    for (size_t i = 0; i < q; i++)
+      hits += uuidv47_idxfile_find(&f, &scratch[i], NULL);
+    double ns = (double)(ns_now() - start) / (double)q;
+    best_find = round >= 0 && ns < best_find ? ns : best_find;
+    start = ns_now();
+    for (size_t i = 0; i < q; i++)
+    {
+      uint64_t t0 = base + xorshift64star(&seed) % 86400000u;
+      hits += uuidv47_idxfile_time_range(&f, t0, t0 + 1000, &first);
+    }
+    ns = (double)(ns_now() - start) / (double)q;
+    best_range = round >= 0 && ns < best_range ? ns : best_range;
+    *out_guard ^= hits ^ first;
+  }
+  printf("== index file, %zu IDs, %zu seconds ==\n", f.n, f.nsec);
+  printf("write %.1f ms, open %.1f us, find %.1f ns, 1 s range %.1f ns\n", (double)t_write / 1e6,
+         (double)t_open / 1e3, best_find, best_range);
+  uuidv47_idxfile_close(&f);
+  remove(path);
+  free(ids);
+  free(scratch);
+}
+
+// Block codec over -n / 2 (1M by default) time-ordered v7 IDs arriving ~1 per
+// millisecond on average (gaps of 0..2 ms): bytes per ID and encode/decode cost.
+static void bench_codec(const cfg_t *c, uint64_t *out_guard)
+{
+  const size_t n = bench_size(c, 1, 2);
+  uuid128_t *ids = malloc(n * sizeof(uuid128_t)), *back = malloc(n * sizeof(uuid128_t));
+  uint8_t *buf = malloc(uuidv47_block_bound(n));
+  if (!ids || !back || !buf)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0x452821e638d01377ULL, ts = 0x0190a1b2c3d4ULL;
+  for (size_t i = 0; i < n; i++)
+  {
+    ts += xorshift64star(&seed) % 3;
+    craft_v7(&ids[i], ts, (uint16_t)(xorshift64star(&seed) & 0x0FFFu), xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  }
+  memset(back, 0, n * sizeof(uuid128_t));
+
+  double best_enc = 1e300, best_dec = 1e300;
+  size_t len = 0, got = 0;
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    len = uuidv47_blocks_encode(ids, n, buf);
+    double enc = (double)(ns_now() - start) / (double)n;
+    start = ns_now();
+    uuidv47_blocks_decode(buf, len, back, n, &got);
+    double dec = (double)(ns_now() - start) / (double)n;
+    best_enc = round >= 0 && enc < best_enc ? enc : best_enc;
+    best_dec = round >= 0 && dec < best_dec ? dec : best_dec;
+    *out_guard ^= back[got / 2].b[9];
+  }
+  if (got != n || memcmp(back, ids, n * sizeof(uuid128_t)) != 0)
+  {
+    fprintf(stderr, "block codec round-trip mismatch\n");
+    exit(2);
+  }
+  printf("== block codec, %zu IDs ==\n", n);
+  printf("%.2f bytes/ID (16 raw), encode %.2f ns/ID, decode %.2f ns/ID\n", (double)len / (double)n, best_enc,
+         best_dec);
+  free(ids);
+  free(back);
+  free(buf);
+}
+
+static void bench_parallel(const cfg_t *c, uint64_t *out_guard)
+{
+  const size_t n = bench_size(c, 2, 1); // 4M IDs by default
+  uuid128_t *in = malloc(n * sizeof(uuid128_t));
+  uuid128_t *out = malloc(n * sizeof(uuid128_t));
+  if (!in || !out)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0x243f6a8885a308d3ULL;
+  for (size_t i = 0; i < n; i++)
+    craft_v7(&in[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  memset(out, 0, n * sizeof(uuid128_t)); // fault the pages in before timing
+
+  unsigned max_t = c->threads;
+  if (max_t == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    max_t = online > 0 ? (unsigned)online : 1u;
+  }
+  if (max_t > UUIDV47_MAX_THREADS)
+    max_t = UUIDV47_MAX_THREADS;
+
+  static uuidv47_thread_stats_t stats[UUIDV47_MAX_THREADS];
+  printf("== parallel encode, %zu IDs ==\n%-8s %12s %14s %14s %8s\n", n, "threads", "Mops/s", "worker min", "worker max",
+         "stolen");
+  for (unsigned t = 1;;)
+  {
+    double best = 0, wmin = 0, wmax = 0;
+    size_t stolen = 0;
+    for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+    {
+      uint64_t start = ns_now();
+      unsigned used = uuidv47_ctx_encode_parallel(&bench_ctx, in, out, n, t, stats);
+      double mops = (double)n * 1000.0 / (double)(ns_now() - start);
+      *out_guard ^= out[n / 2].b[0];
+      if (round < 0 || mops <= best)
+        continue;
+      best = mops;
+      wmin = 1e300;
+      wmax = 0;
+      stolen = 0;
+      for (unsigned w = 0; w < used; w++)
+      {
+        double wm = stats[w].ns ? (double)stats[w].ids * 1000.0 / (double)stats[w].ns : 0;
+        wmin = wm < wmin ? wm : wmin;
+        wmax = wm > wmax ? wm : wmax;
+        stolen += stats[w].stolen;
+      }
+    }
+    printf("%-8u %12.1f %14.1f %14.1f %8zu\n", t, best, wmin, wmax, stolen);
+    if (t >= max_t)
+      break;
+    t = t * 2 < max_t ? t * 2 : max_t;
+  }
+  free(in);
+  free(out);
+}
+
+// Cross-node penalty: the same parallel encode with the caller (and so every
+// worker) restricted to the first node's CPUs, buffers bound to that node vs.
+// to the second one; then buffers split across nodes with the NUMA-aware mode
+// vs. the plain parallel transform. Needs two nodes with CPUs.
+static double bench_numa_run(const cfg_t *c, uuid128_t *in, uuid128_t *out, size_t n, bool numa_mode,
+                             uint64_t *out_guard)
+{
+  double best = 0;
+  for (int round = -(c->warmup_rounds); round < c->measured_rounds; round++)
+  {
+    uint64_t start = ns_now();
+    if (numa_mode)
+      uuidv47_ctx_encode_parallel_numa(&bench_ctx, in, out, n, 0, NULL);
+    else
+      uuidv47_ctx_encode_parallel(&bench_ctx, in, out, n, 0, NULL);
+    double mops = (double)n * 1000.0 / (double)(ns_now() - start);
+    *out_guard ^= out[n / 3].b[0];
+    if (round >= 0 && mops > best)
+      best = mops;
+  }
+  return best;
+}
+
+static void bench_numa(const cfg_t *c, uint64_t *out_guard)
+{
+  uuidv47_numa_topology_t topo;
+  uuidv47_numa_topology(&topo);
+  printf("== NUMA ==\n");
+  if (topo.nodes < 2)
+  {
+    printf("1 node with CPUs: cross-node rows skipped\n");
+    return;
+  }
+  const size_t n = bench_size(c, 4, 1); // 8M IDs by default
+  const size_t bytes = n * sizeof(uuid128_t);
+  uuid128_t *in = malloc(bytes), *out = malloc(bytes);
+  if (!in || !out)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(2);
+  }
+  uint64_t seed = (uint64_t)ns_now() ^ 0x13198a2e03707344ULL;
+  for (size_t i = 0; i < n; i++)
+    craft_v7(&in[i], xorshift64star(&seed) & 0x0000FFFFFFFFFFFFULL, (uint16_t)(xorshift64star(&seed) & 0x0FFFu),
+             xorshift64star(&seed) & ((1ULL << 62) - 1ULL));
+  memset(out, 0, bytes);
+
+  cpu_set_t saved;
+  sched_getaffinity(0, sizeof(saved), &saved);
+  sched_setaffinity(0, sizeof(cpu_set_t), &topo.cpus[0]);
+  bool placed = uuidv47_numa_place(in, bytes, topo.id[0]) && uuidv47_numa_place(out, bytes, topo.id[0]);
+  double local = bench_numa_run(c, in, out, n, false, out_guard);
+  placed = placed && uuidv47_numa_place(in, bytes, topo.id[1]) && uuidv47_numa_place(out, bytes, topo.id[1]);
+  double remote = bench_numa_run(c, in, out, n, false, out_guard);
+  sched_setaffinity(0, sizeof(saved), &saved);
+  if (!placed)
+    printf("(mbind refused: placement below is whatever the kernel chose)\n");
+  printf("node %u CPUs, node %u memory : %8.1f Mops/s\n", topo.id[0], topo.id[0], local);
+  printf("node %u CPUs, node %u memory : %8.1f Mops/s (%.0f%% of local)\n", topo.id[0], topo.id[1], remote,
+         100.0 * remote / local);
+
+  // first half of each buffer on node 0, second half on node 1
+  uuidv47_numa_place(in, bytes / 2, topo.id[0]);
+  uuidv47_numa_place(out, bytes / 2, topo.id[0]);
+  uuidv47_numa_place((uint8_t *)in + bytes / 2, bytes / 2, topo.id[1]);
+  uuidv47_numa_place((uint8_t *)out + bytes / 2, bytes / 2, topo.id[1]);
+  printf("split memory, plain        : %8.1f Mops/s\n", bench_numa_run(c, in, out, n, false, out_guard));
+  printf("split memory, NUMA mode    : %8.1f Mops/s\n", bench_numa_run(c, in, out, n, true, out_guard));
+  free(in);
+  free(out);
+}
+
+int main(int argc, char **argv)
+{
+  cfg_t cfg;
+  parse_args(argc, argv, &cfg);
+
+  // Fixed demo key (replace in prod)
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+
+  if (!cfg.quiet)
+  {
+    printf("iters=%u, warmup=%d, rounds=%d\n", cfg.iters, cfg.warmup_rounds, cfg.measured_rounds);
+  }
+
+  uint64_t guard = 0;
+  double ns_encode_decode = bench_encode_decode(&cfg, key, &guard);
+  double ns_siphash = bench_siphash_only(&cfg, key, &guard);
+  double ns_siphash10 = bench_siphash24_10(&cfg, key, &guard);
+  double ns_array_scalar = bench_array_roundtrip(&cfg, "array scalar", scalar_encode_array, scalar_decode_array, key, &guard);
+  uuidv47_ctx_init(&bench_ctx, key);
+  uuidv47_ctx_init_prf(&bench_ctx13, key, UUIDV47_PRF_SIPHASH13);
+  bool have_aes = uuidv47_ctx_init_prf(&bench_ctx_aes, key, UUIDV47_PRF_AES128);
+  if (!have_aes)
+    bench_ctx_aes = bench_ctx; // no AES-NI: the aes rows fall back to SipHash-2-4
+  double ns_array_ctx = bench_array_roundtrip(&cfg, "array ctx", ctx_encode_array, ctx_decode_array, key, &guard);
+  double ns_array_x4 = bench_array_roundtrip(&cfg, "array x4 scalar", x4_encode_array, x4_decode_array, key, &guard);
+  double ns_array_aes = bench_array_roundtrip(&cfg, "array aes", aes_encode_array, aes_decode_array, key, &guard);
+  double ns_parse_scalar = bench_parse(&cfg, "parse scalar", uuid_parse_scalar, &guard);
+  double ns_parse = bench_parse(&cfg, "parse", uuid_parse, &guard);
+  double ns_parse_any = bench_parse(&cfg, "parse any", parse_any_canonical, &guard);
+  double ns_format_scalar = bench_format(&cfg, "format scalar", uuid_format36_scalar, &guard);
+  double ns_format = bench_format(&cfg, "format", uuid_format36, &guard);
+  double ns_text_lines = bench_text_lines(&cfg, &guard);
+  double ns_inplace = bench_inplace(&cfg, &guard);
+  double ns_soa = bench_soa(&cfg, &guard);
+  double ns_ts_decode = bench_facade_ts(&cfg, "ts via decode", 0, &guard);
+  double ns_ts_single = bench_facade_ts(&cfg, "ts only", 1, &guard);
+  double ns_ts_batch = bench_facade_ts(&cfg, "ts batch", 2, &guard);
+  double ns_scan_scalar = bench_time_scan(&cfg, "scan scalar", 0, &guard);
+  double ns_scan_bitmap = bench_time_scan(&cfg, "scan bitmap", 1, &guard);
+  double ns_scan_index = bench_time_scan(&cfg, "scan index", 2, &guard);
+  double ns_scan_hist = bench_time_scan(&cfg, "scan histogram", 3, &guard);
+  double ns_rows_copy = bench_rows(&cfg, "rows copy+batch", false, &guard);
+  double ns_rows_strided = bench_rows(&cfg, "rows strided", true, &guard);
+  double ns_base32 = bench_compact(&cfg, "base32", uuid_format_base32, uuid_parse_base32, &guard);
+  double ns_b64_scalar = bench_compact(&cfg, "base64url scalar", uuid_format_base64url_scalar,
+                                       uuid_parse_base64url_scalar, &guard);
+  double ns_b64 = bench_compact(&cfg, "base64url", uuid_format_base64url, uuid_parse_base64url, &guard);
+  double ns_str_unfused = bench_str_roundtrip(&cfg, "str parse+format", false, &guard);
+  double ns_str_fused = bench_str_roundtrip(&cfg, "str fused", true, &guard);
+  double ns_array_batch = bench_array_roundtrip(&cfg, "array batch", uuidv47_encode_batch, uuidv47_decode_batch, key, &guard);
+
+  bench_batch_sizes(&cfg, key, &guard);
+  bench_parallel(&cfg, &guard);
+  bench_sort(&cfg, &guard);
+  bench_lookup(&cfg, &guard);
+  bench_idxfile(&cfg, &guard);
+  bench_codec(&cfg, &guard);
+  bench_numa(&cfg, &guard);
 
   // prevent optimizing away
   volatile uint64_t sink = guard;
@@ -228,5 +1432,34 @@ int main(int argc, char **argv)
   printf("== best results ==\n");
   printf("encode+decode : %.2f ns/op (%.1f Mops/s)\n", ns_encode_decode, 1000.0 / ns_encode_decode);
   printf("siphash(10B)  : %.2f ns/op (%.1f Mops/s)\n", ns_siphash, 1000.0 / ns_siphash);
+  printf("siphash24_10  : %.2f ns/op (%.1f Mops/s)\n", ns_siphash10, 1000.0 / ns_siphash10);
+  printf("array scalar  : %.2f ns/op (%.1f Mops/s)\n", ns_array_scalar, 1000.0 / ns_array_scalar);
+  printf("array ctx     : %.2f ns/op (%.1f Mops/s)\n", ns_array_ctx, 1000.0 / ns_array_ctx);
+  printf("array x4      : %.2f ns/op (%.1f Mops/s)\n", ns_array_x4, 1000.0 / ns_array_x4);
+  printf("array batch   : %.2f ns/op (%.1f Mops/s)\n", ns_array_batch, 1000.0 / ns_array_batch);
+  printf("array inplace : %.2f ns/op (%.1f Mops/s)\n", ns_inplace, 1000.0 / ns_inplace);
+  printf("array soa     : %.2f ns/op (%.1f Mops/s)\n", ns_soa, 1000.0 / ns_soa);
+  printf("ts via decode : %.2f ns/op (%.1f Mops/s)\n", ns_ts_decode, 1000.0 / ns_ts_decode);
+  printf("ts only       : %.2f ns/op (%.1f Mops/s)\n", ns_ts_single, 1000.0 / ns_ts_single);
+  printf("ts batch      : %.2f ns/op (%.1f Mops/s)\n", ns_ts_batch, 1000.0 / ns_ts_batch);
+  printf("scan scalar   : %.2f ns/op (%.1f Mops/s)\n", ns_scan_scalar, 1000.0 / ns_scan_scalar);
+  printf("scan bitmap   : %.2f ns/op (%.1f Mops/s)\n", ns_scan_bitmap, 1000.0 / ns_scan_bitmap);
+  printf("scan index    : %.2f ns/op (%.1f Mops/s)\n", ns_scan_index, 1000.0 / ns_scan_index);
+  printf("scan histogram: %.2f ns/op (%.1f Mops/s)\n", ns_scan_hist, 1000.0 / ns_scan_hist);
+  printf("rows copy     : %.2f ns/op (%.1f Mops/s)\n", ns_rows_copy, 1000.0 / ns_rows_copy);
+  printf("rows strided  : %.2f ns/op (%.1f Mops/s)\n", ns_rows_strided, 1000.0 / ns_rows_strided);
+  printf("parse scalar  : %.2f ns/op (%.1f Mops/s)\n", ns_parse_scalar, 1000.0 / ns_parse_scalar);
+  printf("parse         : %.2f ns/op (%.1f Mops/s)\n", ns_parse, 1000.0 / ns_parse);
+  printf("parse any     : %.2f ns/op (%.1f Mops/s)\n", ns_parse_any, 1000.0 / ns_parse_any);
+  printf("format scalar : %.2f ns/op (%.1f Mops/s)\n", ns_format_scalar, 1000.0 / ns_format_scalar);
+  printf("format        : %.2f ns/op (%.1f Mops/s)\n", ns_format, 1000.0 / ns_format);
+  printf("text lines    : %.2f ns/op (%.1f Mops/s)\n", ns_text_lines, 1000.0 / ns_text_lines);
+  printf("str unfused   : %.2f ns/op (%.1f Mops/s)\n", ns_str_unfused, 1000.0 / ns_str_unfused);
+  printf("str fused     : %.2f ns/op (%.1f Mops/s)\n", ns_str_fused, 1000.0 / ns_str_fused);
+  printf("base32        : %.2f ns/op (%.1f Mops/s)\n", ns_base32, 1000.0 / ns_base32);
+  printf("b64url scalar : %.2f ns/op (%.1f Mops/s)\n", ns_b64_scalar, 1000.0 / ns_b64_scalar);
+  printf("base64url     : %.2f ns/op (%.1f Mops/s)\n", ns_b64, 1000.0 / ns_b64);
+  printf("array aes     : %.2f ns/op (%.1f Mops/s)%s\n", ns_array_aes, 1000.0 / ns_array_aes,
+         have_aes ? "" : " [no AES-NI: SipHash-2-4]");
   return 0;
 }
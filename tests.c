@@ -1,12 +1,18 @@
 // Copyright (c) 2025 Stateless Limited
 // SPDX-License-Identifier: MIT
 
+#define _GNU_SOURCE // sched/syscall declarations for the NUMA mode
+
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
+#define UUIDV47_ENABLE_THREADS 1
+#define UUIDV47_ENABLE_NUMA 1
+#define UUIDV47_ENABLE_MMAP 1
 #include "uuidv47.h"
 
 static uint64_t le_bytes_to_u64(const uint8_t b[8])
@@ -89,6 +95,37 @@ static void test_siphash_switch_and_vectors_subset(void)
   (void)siphash24(msg, 15, k0, k1); // exercise extra tail paths
 }
 
+static void test_siphash24_10_fixed_length(void)
+{
+  const uint64_t k0 = 0x0706050403020100ULL;
+  const uint64_t k1 = 0x0f0e0d0c0b0a0908ULL;
+  const uint8_t v10[8] = {0xf3, 0xb9, 0xdd, 0x94, 0xc5, 0xbb, 0x5d, 0x7a}; // reference, len 10
+
+  uint8_t msg[10];
+  for (int i = 0; i < 10; i++)
+    msg[i] = (uint8_t)i;
+  uint64_t m1 = (uint64_t)msg[8] | ((uint64_t)msg[9] << 8) | (10ULL << 56);
+  assert(siphash24_10(rd64le(msg), m1, k0, k1) == le_bytes_to_u64(v10));
+
+  // A v7 whose random field is exactly msg[0..9] yields the same words.
+  uuid128_t u = (uuid128_t){{0}};
+  u.b[6] = 0x70;
+  u.b[7] = 0x01;
+  u.b[8] = 0x82;
+  for (int i = 9; i < 16; i++)
+    u.b[i] = (uint8_t)(i - 6);
+  assert(uuidv47_mask48(&u, k0, k1) == (le_bytes_to_u64(v10) & 0x0000FFFFFFFFFFFFULL));
+
+  // and agrees with the general routine on arbitrary messages
+  for (int i = 0; i < 256; i++)
+  {
+    for (int j = 0; j < 10; j++)
+      msg[j] = (uint8_t)(i * 31 + j * 7);
+    uint64_t w1 = (uint64_t)msg[8] | ((uint64_t)msg[9] << 8) | (10ULL << 56);
+    assert(siphash24_10(rd64le(msg), w1, k0, k1) == siphash24(msg, sizeof(msg), k0, k1));
+  }
+}
+
 static void craft_v7(uuid128_t *u, uint64_t ts_ms_48, uint16_t rand_a_12, uint64_t rand_b_62)
 {
   memset(u, 0, sizeof(*u));
@@ -140,14 +177,1129 @@ static void test_encode_decode_roundtrip(void)
   }
 }
 
+static void test_batch_matches_scalar(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuid128_t v7[37], fac[37], back[37];
+
+  for (size_t i = 0; i < 37; i++)
+  {
+    uint64_t ts = 0x0189ABCDEF00ULL + (uint64_t)i * 977ULL;
+    uint16_t ra = (uint16_t)((0x0123 * (uint32_t)(i + 1)) & 0x0FFF);
+    uint64_t rb = (0x0F1E2D3C4B5A6978ULL * (uint64_t)(i + 3)) & ((1ULL << 62) - 1);
+    craft_v7(&v7[i], ts, ra, rb);
+  }
+
+  // every batch length exercises a different vector/tail split
+  for (size_t n = 0; n <= 37; n++)
+  {
+    uuidv47_encode_batch(v7, fac, n, key);
+    for (size_t i = 0; i < n; i++)
+    {
+      uuid128_t exp = uuidv47_encode_v4facade(v7[i], key);
+      assert(memcmp(&fac[i], &exp, sizeof(exp)) == 0);
+    }
+    uuidv47_decode_batch(fac, back, n, key);
+    assert(memcmp(back, v7, n * sizeof(uuid128_t)) == 0);
+  }
+
+  // in-place
+  memcpy(back, v7, sizeof(v7));
+  uuidv47_encode_batch(back, back, 37, key);
+  assert(memcmp(back, fac, sizeof(fac)) == 0);
+  uuidv47_decode_batch(back, back, 37, key);
+  assert(memcmp(back, v7, sizeof(v7)) == 0);
+}
+
+static void test_simd_kernels_match_reference(void)
+{
+  const uint64_t k0 = 0x0706050403020100ULL;
+  const uint64_t k1 = 0x0f0e0d0c0b0a0908ULL;
+  uuid128_t u[8];
+  uint64_t m0[8], m1[8], exp[8];
+
+  for (size_t i = 0; i < 8; i++)
+  {
+    craft_v7(&u[i], 0x0123456789ABULL ^ (uint64_t)i, (uint16_t)(0x0F0F ^ i),
+             (0x3A5A5A5A5A5A5A5AULL >> i) & ((1ULL << 62) - 1));
+    uint8_t msg[10];
+    build_sip_input_from_v7(&u[i], msg);
+    exp[i] = siphash24(msg, sizeof(msg), k0, k1);
+    sip_words_from_uuid(&u[i], &m0[i], &m1[i]);
+  }
+
+  uint64_t init[4];
+  sip_init_state(init, k0, k1);
+  uuidv47_simd_level_t level = uuidv47_simd_level();
+  uint64_t got[8];
+  siphash_10_x4_portable(init, 2, 4, m0, m1, got);
+  assert(memcmp(got, exp, 4 * sizeof(uint64_t)) == 0);
+  (void)level;
+#if UUIDV47_X86_SIMD
+  if (level >= UUIDV47_SIMD_AVX2)
+  {
+    siphash_10_x4_avx2(init, 2, 4, m0, m1, got);
+    assert(memcmp(got, exp, 4 * sizeof(uint64_t)) == 0);
+  }
+  if (level >= UUIDV47_SIMD_AVX512)
+  {
+    siphash_10_x8_avx512(init, 2, 4, m0, m1, got);
+    assert(memcmp(got, exp, sizeof(exp)) == 0);
+  }
+#endif
+}
+
+static void test_ctx_matches_key_api(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+  assert(((uintptr_t)&ctx & 63u) == 0);
+
+  uuid128_t v7[19], fac[19], back[19];
+  for (size_t i = 0; i < 19; i++)
+  {
+    craft_v7(&v7[i], 0x018F00000000ULL + (uint64_t)i, (uint16_t)(i * 211),
+             (0x2545F4914F6CDD1DULL * (uint64_t)(i + 1)) & ((1ULL << 62) - 1));
+    uuid128_t exp = uuidv47_encode_v4facade(v7[i], key);
+    uuid128_t got = uuidv47_ctx_encode(&ctx, &v7[i]);
+    assert(memcmp(&got, &exp, sizeof(exp)) == 0);
+    uuid128_t dec = uuidv47_ctx_decode(&ctx, &got);
+    assert(memcmp(&dec, &v7[i], sizeof(dec)) == 0);
+  }
+
+  uuidv47_ctx_encode_batch(&ctx, v7, fac, 19);
+  uuidv47_encode_batch(v7, back, 19, key);
+  assert(memcmp(fac, back, sizeof(fac)) == 0);
+  uuidv47_ctx_decode_batch(&ctx, fac, back, 19);
+  assert(memcmp(back, v7, sizeof(v7)) == 0);
+
+  // every kernel level this CPU supports, including the portable 4-stream one
+  for (int lvl = 0; lvl <= (int)uuidv47_simd_level(); lvl++)
+  {
+    uuid128_t got[19];
+    uuidv47_transform_batch(&ctx, v7, got, 19, 4, (uuidv47_simd_level_t)lvl);
+    assert(memcmp(got, fac, sizeof(fac)) == 0);
+  }
+}
+
+static void test_bitsliced_matches_scalar(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0706050403020100ULL, .k1 = 0x0f0e0d0c0b0a0908ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  uint64_t a[64];
+  for (size_t i = 0; i < 64; i++)
+    a[i] = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+  uint64_t t[64];
+  memcpy(t, a, sizeof(a));
+  sip_bs_transpose64(t);
+  for (int i = 0; i < 64; i++)
+    for (int j = 0; j < 64; j++)
+      assert(((t[i] >> j) & 1u) == ((a[j] >> i) & 1u));
+
+  uuid128_t v7[150], fac[150], exp[150];
+  for (size_t i = 0; i < 150; i++)
+    craft_v7(&v7[i], 0x019000000000ULL + (uint64_t)(i * 3), (uint16_t)(i * 37),
+             (0xD6E8FEB86659FD93ULL * (uint64_t)(i + 7)) & ((1ULL << 62) - 1));
+  uuidv47_ctx_encode_batch(&ctx, v7, exp, 150);
+  uuidv47_ctx_encode_batch_bitsliced(&ctx, v7, fac, 150);
+  assert(memcmp(fac, exp, sizeof(exp)) == 0);
+  uuidv47_ctx_decode_batch_bitsliced(&ctx, fac, fac, 150);
+  assert(memcmp(fac, v7, sizeof(v7)) == 0);
+}
+
+static void test_prf_modes_vectors(void)
+{
+  const uint64_t k0 = 0x0706050403020100ULL;
+  const uint64_t k1 = 0x0f0e0d0c0b0a0908ULL;
+  uint64_t init[4];
+  sip_init_state(init, k0, k1);
+  uint8_t msg[10];
+  for (int i = 0; i < 10; i++)
+    msg[i] = (uint8_t)i;
+  uint64_t m0 = rd64le(msg);
+  uint64_t m1 = (uint64_t)msg[8] | ((uint64_t)msg[9] << 8) | (10ULL << 56);
+  assert(siphash24_10_state(init, m0, m1) == 0x7a5dbbc594ddb9f3ULL);
+  assert(siphash13_10_state(init, m0, m1) == 0x79de85ee92ff097fULL);
+
+  // pinned façades of the demo v7 under both PRFs
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuid128_t v7, want24, want13;
+  assert(uuid_parse("018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", &v7));
+  assert(uuid_parse("2463c780-7fca-4def-8c3f-7b1a2c4d5e6f", &want24));
+  assert(uuid_parse("cd56abff-54fe-4def-8c3f-7b1a2c4d5e6f", &want13));
+
+  uuidv47_ctx_t c24, c13;
+  assert(uuidv47_ctx_init_prf(&c24, key, UUIDV47_PRF_SIPHASH24));
+  assert(uuidv47_ctx_init_prf(&c13, key, UUIDV47_PRF_SIPHASH13));
+  assert(uuidv47_ctx_prf(&c13) == UUIDV47_PRF_SIPHASH13);
+  assert(!uuidv47_ctx_init_prf(&c13, key, (uuidv47_prf_t)99) && uuidv47_ctx_init_prf(&c13, key, UUIDV47_PRF_SIPHASH13));
+
+  uuid128_t f24 = uuidv47_ctx_encode(&c24, &v7);
+  uuid128_t f13 = uuidv47_ctx_encode(&c13, &v7);
+  assert(memcmp(&f24, &want24, sizeof(f24)) == 0);
+  assert(memcmp(&f13, &want13, sizeof(f13)) == 0);
+  uuid128_t d13 = uuidv47_ctx_decode(&c13, &f13);
+  uuid128_t mixed = uuidv47_ctx_decode(&c24, &f13);
+  assert(memcmp(&d13, &v7, sizeof(v7)) == 0);
+  assert(memcmp(&mixed, &v7, sizeof(v7)) != 0);
+
+  // every batch kernel honours the context's PRF
+  uuid128_t in[70], exp[70], got[70];
+  for (size_t i = 0; i < 70; i++)
+  {
+    craft_v7(&in[i], 0x018F2D9F9A2AULL + (uint64_t)i, (uint16_t)(i * 13), (0x1234567ULL * (uint64_t)(i + 1)) & ((1ULL << 62) - 1));
+    exp[i] = uuidv47_ctx_encode(&c13, &in[i]);
+  }
+  for (int lvl = 0; lvl <= (int)uuidv47_simd_level(); lvl++)
+  {
+    uuidv47_transform_batch(&c13, in, got, 70, 4, (uuidv47_simd_level_t)lvl);
+    assert(memcmp(got, exp, sizeof(exp)) == 0);
+  }
+  uuidv47_ctx_encode_batch_bitsliced(&c13, in, got, 70);
+  assert(memcmp(got, exp, sizeof(exp)) == 0);
+}
+
+static void test_aes_prf(void)
+{
+#if UUIDV47_X86_SIMD
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  if (!uuidv47_ctx_init_prf(&ctx, key, UUIDV47_PRF_AES128))
+  {
+    assert(!uuidv47_cpu_has_aesni());
+    return;
+  }
+
+  // FIPS-197 C.1 known answer through the expanded schedule
+  uuidv47_ctx_t fips;
+  uuidv47_key_t fk = {.k0 = 0x0706050403020100ULL, .k1 = 0x0f0e0d0c0b0a0908ULL};
+  assert(uuidv47_ctx_init_prf(&fips, fk, UUIDV47_PRF_AES128));
+  const uint8_t pt[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+  const uint8_t ct[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+  uint8_t got_ct[16];
+  _mm_storeu_si128((__m128i *)(void *)got_ct,
+                   aes128_encrypt_aesni(fips.aes_rk, _mm_loadu_si128((const __m128i *)(const void *)pt)));
+  assert(memcmp(got_ct, ct, 16) == 0);
+
+  // pinned façade of the demo v7
+  uuid128_t v7, want;
+  assert(uuid_parse("018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", &v7));
+  assert(uuid_parse("470bcc25-cdd6-4def-8c3f-7b1a2c4d5e6f", &want));
+  uuid128_t f = uuidv47_ctx_encode(&ctx, &v7);
+  assert(memcmp(&f, &want, sizeof(f)) == 0);
+  uuid128_t back = uuidv47_ctx_decode(&ctx, &f);
+  assert(memcmp(&back, &v7, sizeof(v7)) == 0);
+
+  // batch kernels (VAES x16, AES-NI x8, single) agree with the per-ID path
+  uuid128_t in[45], exp[45], got[45];
+  for (size_t i = 0; i < 45; i++)
+  {
+    craft_v7(&in[i], 0x0190AABBCCDDULL + (uint64_t)i, (uint16_t)(i * 91), (0xABCDEF12345ULL * (uint64_t)(i + 5)) & ((1ULL << 62) - 1));
+    exp[i] = uuidv47_ctx_encode(&ctx, &in[i]);
+  }
+  for (int lvl = 0; lvl <= (int)uuidv47_simd_level(); lvl++)
+  {
+    uuidv47_transform_batch(&ctx, in, got, 45, 4, (uuidv47_simd_level_t)lvl);
+    assert(memcmp(got, exp, sizeof(exp)) == 0);
+  }
+  uuidv47_ctx_encode_batch_bitsliced(&ctx, in, got, 45);
+  assert(memcmp(got, exp, sizeof(exp)) == 0);
+  uuidv47_ctx_decode_batch(&ctx, got, got, 45);
+  assert(memcmp(got, in, sizeof(in)) == 0);
+#endif
+}
+
+static void test_uuid_parse_strict_and_simd(void)
+{
+  const char *good = "018F2d9f-9a2a-7DEF-8c3f-7b1a2c4d5e6f";
+  uuid128_t a, b;
+  assert(uuid_parse_scalar(good, &a));
+  assert(a.b[0] == 0x01 && a.b[1] == 0x8F && a.b[6] == 0x7D && a.b[15] == 0x6F);
+
+  // hyphens must sit at 8, 13, 18, 23
+  assert(!uuid_parse("018f2d9f9-a2a-7def-8c3f-7b1a2c4d5e6f", &b));
+  assert(!uuid_parse("018f2d9f-9a2a-7def-8c3f7-b1a2c4d5e6f", &b));
+  assert(!uuid_parse_scalar("018f2d9f_9a2a-7def-8c3f-7b1a2c4d5e6f", &b));
+
+#if UUIDV47_X86_SIMD
+  if (!uuidv47_cpu_has_sse41())
+    return;
+  assert(uuid_parse_sse41(good, &b) && memcmp(&a, &b, sizeof(a)) == 0);
+
+  // every position x a spread of bytes: SIMD and scalar must agree
+  static const char probes[] = {'0', '9', 'a', 'f', 'A', 'F', 'g', 'G', '-', '/', ':', '@', '`', ' ', (char)0x80, (char)0xE1};
+  char buf[37];
+  for (int pos = 0; pos < 36; pos++)
+  {
+    for (size_t k = 0; k < sizeof(probes); k++)
+    {
+      memcpy(buf, good, 37);
+      buf[pos] = probes[k];
+      uuid128_t x = (uuid128_t){{0}}, y = (uuid128_t){{0}};
+      bool rx = uuid_parse_scalar(buf, &x);
+      bool ry = uuid_parse_sse41(buf, &y);
+      assert(rx == ry);
+      if (rx)
+        assert(memcmp(&x, &y, sizeof(x)) == 0);
+    }
+  }
+#endif
+}
+
+static void test_uuid_format_variants(void)
+{
+  uuid128_t u;
+  assert(uuid_parse("018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", &u));
+  char out[40];
+  memset(out, 'x', sizeof(out));
+  uuid_format36(&u, out, true);
+  assert(memcmp(out, "018F2D9F-9A2A-7DEF-8C3F-7B1A2C4D5E6F", 36) == 0);
+  assert(out[36] == 'x'); // no terminator written
+  uuid_format(&u, out);
+  assert(strcmp(out, "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f") == 0);
+
+  // dispatched and scalar agree for all byte values in every position
+  for (int i = 0; i < 256; i++)
+  {
+    for (int k = 0; k < 16; k++)
+      u.b[k] = (uint8_t)(i * 17 + k * 29);
+    char a[36], b[36];
+    for (int up = 0; up < 2; up++)
+    {
+      uuid_format36_scalar(&u, a, up != 0);
+      uuid_format36(&u, b, up != 0);
+      assert(memcmp(a, b, 36) == 0);
+      uuid128_t back;
+      assert(uuid_parse(b, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+    }
+  }
+}
+
+static void test_text_lines(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  // 150 lines: every 7th is malformed, the last has no trailing newline
+  enum { LINES = 150 };
+  static char text[LINES * 37], enc[LINES * 37], dec[LINES * 37];
+  size_t len = 0;
+  for (size_t i = 0; i < LINES; i++)
+  {
+    if (i % 7 == 3)
+      len += (size_t)sprintf(text + len, "bad line %zu", i);
+    else
+    {
+      uuid128_t u;
+      craft_v7(&u, 0x018f2d9f9a2aULL + (uint64_t)i, (uint16_t)(i * 13), (0x0123456789abcdefULL * (uint64_t)(i + 1)) >> 2);
+      uuid_format(&u, text + len);
+      len += 36;
+    }
+    if (i + 1 < LINES)
+      text[len++] = '\n';
+  }
+
+  uint64_t err[3] = {0};
+  size_t lines = 0;
+  assert(uuidv47_encode_lines(&ctx, text, len, enc, err, 1000, &lines) == len);
+  assert(lines == LINES);
+  for (int i = 0; i < LINES; i++)
+    assert(((err[i / 64] >> (i % 64)) & 1) == (i % 7 == 3));
+
+  // streaming in uneven pieces with in-place output gives the same bytes
+  memcpy(dec, text, len);
+  size_t pos = 0, done = 0;
+  while (pos < len)
+  {
+    uint64_t e[1];
+    size_t got = uuidv47_encode_lines(&ctx, dec + pos, len - pos, dec + pos, e, 23, &lines);
+    for (size_t i = 0; i < lines; i++)
+      assert(((e[0] >> i) & 1) == (((done + i) % 7) == 3));
+    pos += got;
+    done += lines;
+  }
+  assert(done == LINES && memcmp(dec, enc, len) == 0);
+
+  // first line is a v4 facade in lowercase canonical form
+  uuid128_t f;
+  assert(enc[36] == '\n' && uuid_parse(enc, &f) && uuid_version(&f) == 4);
+  assert(strncmp(enc + 37, text + 37, 36) != 0);
+
+  assert(uuidv47_decode_lines(&ctx, enc, len, dec, err, 1000, &lines) == len);
+  assert(lines == LINES && memcmp(dec, text, len) == 0);
+
+  // wrong version: a v7 line to decode, a v4 line to encode; both pass through flagged
+  const char mixed[] = "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f\n2463c780-7fca-4def-8c3f-7b1a2c4d5e6f";
+  char outm[sizeof mixed];
+  assert(uuidv47_decode_lines(&ctx, mixed, sizeof mixed - 1, outm, err, 10, &lines) == sizeof mixed - 1);
+  assert(lines == 2 && err[0] == 1);
+  assert(strncmp(outm, mixed, 36) == 0 && strncmp(outm + 37, "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", 36) == 0);
+  assert(uuidv47_encode_lines(&ctx, mixed, sizeof mixed - 1, outm, err, 10, &lines) == sizeof mixed - 1);
+  assert(lines == 2 && err[0] == 2);
+  assert(strncmp(outm, "2463c780-7fca-4def-8c3f-7b1a2c4d5e6f", 36) == 0 && strncmp(outm + 37, mixed + 37, 36) == 0);
+
+  // a short line followed by a 32-character one must not be read as one 36-character line
+  const char split[] = "bad\n0123456789abcdef0123456789abcdef\n018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f\n";
+  char outs[sizeof split];
+  assert(uuidv47_encode_lines(&ctx, split, sizeof split - 1, outs, err, 10, &lines) == sizeof split - 1);
+  assert(lines == 3 && err[0] == 3);
+  assert(memcmp(outs, split, 37) == 0 && outs[73] == '\n');
+  assert(uuid_parse(outs + 37, &f) && uuid_version(&f) == 4);
+}
+
+static void test_fused_string_transform(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  char f[37] = {0}, v[37] = {0};
+  assert(uuidv47_v7_str_to_facade_str(&ctx, "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", f));
+  assert(strcmp(f, "2463c780-7fca-4def-8c3f-7b1a2c4d5e6f") == 0);
+  assert(uuidv47_facade_str_to_v7_str(&ctx, f, v));
+  assert(strcmp(v, "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f") == 0);
+
+  // uppercase in, uppercase out; in place
+  char up[37] = "018F2D9F-9A2A-7DEF-8C3F-7B1A2C4D5E6F";
+  assert(uuidv47_v7_str_to_facade_str(&ctx, up, up));
+  assert(strcmp(up, "2463C780-7FCA-4DEF-8C3F-7B1A2C4D5E6F") == 0);
+
+  // wrong version, bad hex and misplaced hyphens are rejected without writing
+  memset(v, 'x', 36);
+  assert(!uuidv47_facade_str_to_v7_str(&ctx, "018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", v));
+  assert(!uuidv47_v7_str_to_facade_str(&ctx, "018f2d9f-9a2a-7def-8c3g-7b1a2c4d5e6f", v));
+  assert(!uuidv47_v7_str_to_facade_str(&ctx, "018f2d9f-9a2a-7def8-c3f-7b1a2c4d5e6f", v));
+  assert(v[0] == 'x' && v[35] == 'x');
+
+  // agrees with parse + ctx_encode + format for assorted IDs and PRFs
+  uint64_t seed = 0x6a09e667f3bcc909ULL;
+  for (int prf = 0; prf < 3; prf++)
+  {
+    if (!uuidv47_ctx_init_prf(&ctx, key, (uuidv47_prf_t)prf))
+      continue;
+    for (int i = 0; i < 200; i++)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      uuid128_t u7, fac;
+      craft_v7(&u7, seed >> 16, (uint16_t)(seed >> 4), seed & ((1ULL << 62) - 1));
+      char s7[37], want[37], got[36];
+      uuid_format(&u7, s7);
+      fac = uuidv47_ctx_encode(&ctx, &u7);
+      uuid_format(&fac, want);
+      assert(uuidv47_v7_str_to_facade_str(&ctx, s7, got) && memcmp(got, want, 36) == 0);
+      assert(uuidv47_facade_str_to_v7_str(&ctx, want, got) && memcmp(got, s7, 36) == 0);
+    }
+  }
+}
+
+static void test_compact_encodings(void)
+{
+  uuid128_t u, back;
+  assert(uuid_parse("018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", &u));
+
+  char b32[27] = {0}, b64[23] = {0};
+  uuid_format_base32(&u, b32);
+  assert(strcmp(b32, "01HWPSZ6HAFQQRRFVV38P4TQKF") == 0);
+  assert(uuid_parse_base32(b32, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+  assert(uuid_parse_base32("01hwpsz6hafqqrrfvv38p4tqkf", &back) && memcmp(&back, &u, sizeof(u)) == 0);
+  assert(uuid_parse_base32("O1HWPSZ6HAFQQRRFVV38P4TQKF", &back) && memcmp(&back, &u, sizeof(u)) == 0);
+  assert(!uuid_parse_base32("81HWPSZ6HAFQQRRFVV38P4TQKF", &back)); // > 128 bits
+  assert(!uuid_parse_base32("01HWPSZ6HAFQQRRFVV38P4TQKU", &back));
+
+  uuid_format_base64url(&u, b64);
+  assert(strcmp(b64, "AY8tn5oqfe-MP3saLE1ebw") == 0);
+  assert(uuid_parse_base64url(b64, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+  assert(!uuid_parse_base64url("AY8tn5oqfe-MP3saLE1ebx", &back)); // spare bits set
+  assert(!uuid_parse_base64url("AY8tn5oqfe+MP3saLE1ebw", &back));
+  assert(!uuid_parse_base64url("AY8tn5oqfe-MP3sa=E1ebw", &back));
+
+  // fused façade path
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+  uuidv47_ctx_encode_base64url(&ctx, &u, b64);
+  assert(strcmp(b64, "JGPHgH_KTe-MP3saLE1ebw") == 0);
+  assert(uuidv47_ctx_decode_base64url(&ctx, b64, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+  assert(!uuidv47_ctx_decode_base64url(&ctx, "AY8tn5oqfe-MP3saLE1ebw", &back)); // a v7, not a façade
+
+  // scalar and dispatched codecs agree; every byte value in every position round-trips
+  for (int i = 0; i < 256; i++)
+  {
+    for (int k = 0; k < 16; k++)
+      u.b[k] = (uint8_t)(i * 31 + k * 57);
+    char a[22], c[22], d[26];
+    uuid_format_base64url_scalar(&u, a);
+    uuid_format_base64url(&u, c);
+    assert(memcmp(a, c, 22) == 0);
+    assert(uuid_parse_base64url_scalar(c, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+    assert(uuid_parse_base64url(c, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+    uuid_format_base32(&u, d);
+    assert(uuid_parse_base32(d, &back) && memcmp(&back, &u, sizeof(u)) == 0);
+    c[i % 22] = (char)'!';
+    assert(!uuid_parse_base64url(c, &back) && !uuid_parse_base64url_scalar(c, &back));
+  }
+}
+
+static void test_uuid_parse_any_forms(void)
+{
+  uuid128_t want, u;
+  assert(uuid_parse("018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", &want));
+
+  static const char *ok[] = {
+      "018f2d9f9a2a7def8c3f7b1a2c4d5e6f",
+      "018F2D9F9A2A7dEf8C3F7B1A2C4D5E6F",
+      "018f2d9f-9a2a-7DEF-8c3f-7b1a2c4d5e6f",
+      "{018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f}",
+      "urn:uuid:018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f",
+      "URN:UUID:018F2D9F-9A2A-7DEF-8C3F-7B1A2C4D5E6F",
+  };
+  for (size_t i = 0; i < sizeof(ok) / sizeof(ok[0]); i++)
+  {
+    memset(&u, 0, sizeof(u));
+    assert(uuid_parse_any(ok[i], strlen(ok[i]), &u) == UUID_PARSE_OK);
+    assert(memcmp(&u, &want, sizeof(u)) == 0);
+  }
+
+  static const struct
+  {
+    const char *s;
+    uuid_parse_status_t st;
+  } bad[] = {
+      {"", UUID_PARSE_ERR_LENGTH},
+      {"018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6", UUID_PARSE_ERR_LENGTH},
+      {"018f2d9f9a2a7def8c3f7b1a2c4d5e6g", UUID_PARSE_ERR_HEX},
+      {"018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6x", UUID_PARSE_ERR_HEX},
+      {"018f2d9f-9a2a-7def-8c3f7-b1a2c4d5e6f", UUID_PARSE_ERR_SYNTAX},
+      {"(018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f)", UUID_PARSE_ERR_SYNTAX},
+      {"{018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f ", UUID_PARSE_ERR_SYNTAX},
+      {"urn:uuid;018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", UUID_PARSE_ERR_SYNTAX},
+      {"urn:uuidz018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6f", UUID_PARSE_ERR_SYNTAX},
+      {"urn:uuid:018f2d9f-9a2a-7def-8c3f-7b1a2c4d5e6-", UUID_PARSE_ERR_SYNTAX},
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    assert(uuid_parse_any(bad[i].s, strlen(bad[i].s), &u) == bad[i].st);
+
+  // the scalar and SIMD 32-digit paths agree on every single-character corruption
+  char hex[32];
+  memcpy(hex, ok[0], 32);
+  for (int pos = 0; pos < 32; pos++)
+    for (int c = 1; c < 256; c++)
+    {
+      char t[32];
+      memcpy(t, hex, 32);
+      t[pos] = (char)c;
+      uuid128_t a, b;
+      bool sa = uuid_parse_hex32_scalar(t, &a);
+      bool sb = uuid_parse_any(t, 32, &b) == UUID_PARSE_OK;
+      assert(sa == sb && (!sa || memcmp(&a, &b, sizeof(a)) == 0));
+    }
+}
+
+static void test_inplace_transform(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  enum { N = 203 };
+  static uuid128_t ids[N], orig[N];
+  uint64_t seed = 0xbb67ae8584caa73bULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    craft_v7(&ids[i], seed >> 16, (uint16_t)(seed >> 3), (seed * 0x9e3779b97f4a7c15ULL) >> 2);
+    if (i % 11 == 5)
+      set_version(&ids[i], 4); // not a v7: must be skipped
+  }
+  memcpy(orig, ids, sizeof(ids));
+
+  for (int prf = 0; prf < 3; prf++)
+  {
+    uuidv47_ctx_t ctx;
+    if (!uuidv47_ctx_init_prf(&ctx, key, (uuidv47_prf_t)prf))
+      continue;
+    uint64_t bad[(N + 63) / 64];
+    size_t expect_ok = 0;
+    for (int i = 0; i < N; i++)
+      expect_ok += (i % 11 != 5);
+
+    assert(uuidv47_encode_inplace(ids, N, &ctx, bad) == expect_ok);
+    for (int i = 0; i < N; i++)
+    {
+      bool skipped = (i % 11 == 5);
+      assert(((bad[i / 64] >> (i % 64)) & 1) == skipped);
+      if (skipped)
+        assert(memcmp(&ids[i], &orig[i], sizeof(uuid128_t)) == 0);
+      else
+      {
+        uuid128_t want = uuidv47_ctx_encode(&ctx, &orig[i]);
+        assert(memcmp(&ids[i], &want, sizeof(uuid128_t)) == 0);
+        assert(memcmp(&ids[i].b[9], &orig[i].b[9], 7) == 0 && ids[i].b[7] == orig[i].b[7]);
+      }
+    }
+
+    // decoding flags everything that is not a façade: the untouched v4 inputs decode too,
+    // so compare against an explicit per-ID decode
+    uuid128_t expect[N];
+    for (int i = 0; i < N; i++)
+      expect[i] = uuid_version(&ids[i]) == 4 ? uuidv47_ctx_decode(&ctx, &ids[i]) : ids[i];
+    assert(uuidv47_decode_inplace(ids, N, &ctx, NULL) == N);
+    assert(memcmp(ids, expect, sizeof(ids)) == 0);
+    for (int i = 0; i < N; i++)
+      if (i % 11 != 5)
+        assert(memcmp(&ids[i], &orig[i], sizeof(uuid128_t)) == 0);
+    memcpy(ids, orig, sizeof(ids));
+  }
+}
+
+static void test_strided_transform(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  // odd-sized records with the ID at an unaligned offset; neighbouring fields must survive
+  enum { N = 77, STRIDE = 29, OFF = 5 };
+  static uint8_t rows[N * STRIDE], orig[N * STRIDE];
+  for (size_t i = 0; i < sizeof(rows); i++)
+    rows[i] = (uint8_t)(i * 151 + 7);
+  for (size_t i = 0; i < N; i++)
+  {
+    uuid128_t u;
+    craft_v7(&u, 0x0190000000000ULL + (uint64_t)i * 977, (uint16_t)(i * 37), 0x2545f4914f6cdd1dULL * (uint64_t)(i + 3) >> 2);
+    if (i == 40)
+      set_version(&u, 1);
+    memcpy(&rows[i * STRIDE + OFF], &u, sizeof(u));
+  }
+  memcpy(orig, rows, sizeof(rows));
+
+  uint64_t bad[2];
+  assert(uuidv47_encode_strided(rows, N, STRIDE, OFF, &ctx, bad) == N - 1);
+  assert(((bad[0] >> 40) & 1) == 1 && (bad[0] & ~(1ULL << 40)) == 0 && bad[1] == 0);
+  for (int i = 0; i < N; i++)
+  {
+    uuid128_t u, want;
+    memcpy(&u, &orig[i * STRIDE + OFF], sizeof(u));
+    want = i == 40 ? u : uuidv47_ctx_encode(&ctx, &u);
+    assert(memcmp(&rows[i * STRIDE + OFF], &want, sizeof(want)) == 0);
+    assert(memcmp(&rows[i * STRIDE], &orig[i * STRIDE], OFF) == 0);
+    assert(memcmp(&rows[i * STRIDE + OFF + 16], &orig[i * STRIDE + OFF + 16], STRIDE - OFF - 16) == 0);
+  }
+  assert(uuidv47_decode_strided(rows, N, STRIDE, OFF, &ctx, NULL) == N - 1);
+  assert(memcmp(rows, orig, sizeof(rows)) == 0);
+}
+
+static void test_soa_layout(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  enum { N = 131 };
+  static uuid128_t ids[N], want[N], back[N];
+  static uint64_t ts[N], lo[N];
+  static uint16_t hi[N];
+  uuidv47_soa_t soa = {ts, lo, hi};
+
+  uint64_t seed = 0x3c6ef372fe94f82bULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    craft_v7(&ids[i], seed >> 16, (uint16_t)(seed >> 5), (seed ^ (seed << 21)) >> 2);
+  }
+
+  uuidv47_soa_from_uuids(ids, N, &soa);
+  for (int i = 0; i < N; i++)
+  {
+    uint64_t m0, m1;
+    sip_words_from_uuid(&ids[i], &m0, &m1);
+    assert(ts[i] == rd48be(ids[i].b) && lo[i] == m0 && (m1 & 0xFFFF) == hi[i]);
+  }
+  uuidv47_soa_to_uuids(&soa, N, 7, back);
+  assert(memcmp(back, ids, sizeof(ids)) == 0);
+
+  for (int prf = 0; prf < 3; prf++)
+  {
+    uuidv47_ctx_t ctx;
+    if (!uuidv47_ctx_init_prf(&ctx, key, (uuidv47_prf_t)prf))
+      continue;
+    uuidv47_soa_from_uuids(ids, N, &soa);
+    uuidv47_soa_encode(&ctx, &soa, N);
+    uuidv47_soa_to_uuids(&soa, N, 4, back);
+    uuidv47_ctx_encode_batch(&ctx, ids, want, N);
+    assert(memcmp(back, want, sizeof(want)) == 0);
+    uuidv47_soa_decode(&ctx, &soa, N);
+    uuidv47_soa_to_uuids(&soa, N, 7, back);
+    assert(memcmp(back, ids, sizeof(ids)) == 0);
+  }
+}
+
+static void test_parallel_transform(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  // not a multiple of the chunk size, more workers than this machine has cores
+  enum { N = 5 * UUIDV47_PARALLEL_CHUNK + 123 };
+  static uuid128_t in[N], want[N], out[N];
+  uint64_t seed = 0xa54ff53a5f1d36f1ULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    craft_v7(&in[i], seed >> 16, (uint16_t)(seed >> 7), (seed * 0xff51afd7ed558ccdULL) >> 2);
+  }
+  uuidv47_ctx_encode_batch(&ctx, in, want, N);
+
+  unsigned counts[] = {1, 3, 8, 0};
+  for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++)
+  {
+    uuidv47_thread_stats_t stats[UUIDV47_MAX_THREADS];
+    memset(out, 0, sizeof(out));
+    unsigned used = uuidv47_ctx_encode_parallel(&ctx, in, out, N, counts[k], stats);
+    assert(used >= 1 && used <= 6); // 6 chunks
+    assert(memcmp(out, want, sizeof(out)) == 0);
+    size_t ids = 0, chunks = 0;
+    for (unsigned t = 0; t < used; t++)
+    {
+      ids += stats[t].ids;
+      chunks += stats[t].chunks;
+    }
+    assert(ids == N && chunks == 6);
+    uuidv47_ctx_decode_parallel(&ctx, out, out, N, counts[k], NULL);
+    assert(memcmp(out, in, sizeof(out)) == 0);
+  }
+
+  // tiny input: a single worker, no chunk split needed
+  uuidv47_thread_stats_t one;
+  assert(uuidv47_ctx_encode_parallel(&ctx, in, out, 3, 16, &one) == 1);
+  assert(one.ids == 3 && memcmp(out, want, 3 * sizeof(uuid128_t)) == 0);
+}
+
+static void test_parallel_numa(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  uuidv47_numa_topology_t topo;
+  uuidv47_numa_topology(&topo);
+  assert(topo.nodes >= 1 && topo.ncpus[0] >= 1);
+
+  enum { N = 3 * UUIDV47_PARALLEL_CHUNK + 7 };
+  static uuid128_t in[N], want[N], out[N];
+  uint64_t seed = 0x510e527fade682d1ULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    craft_v7(&in[i], seed >> 16, (uint16_t)(seed >> 9), (seed * 0xc4ceb9fe1a85ec53ULL) >> 2);
+  }
+  uuidv47_ctx_encode_batch(&ctx, in, want, N);
+
+  uuidv47_thread_stats_t stats[UUIDV47_MAX_THREADS];
+  unsigned used = uuidv47_ctx_encode_parallel_numa(&ctx, in, out, N, 2, stats);
+  assert(used >= 1 && memcmp(out, want, sizeof(out)) == 0);
+  size_t ids = 0, chunks = 0;
+  for (unsigned t = 0; t < used; t++)
+  {
+    ids += stats[t].ids;
+    chunks += stats[t].chunks;
+    assert(stats[t].stolen == 0);
+    bool known = false;
+    for (unsigned k = 0; k < topo.nodes; k++)
+      known |= stats[t].node == topo.id[k];
+    assert(known);
+  }
+  assert(ids == N && chunks == 4);
+  uuidv47_ctx_decode_parallel_numa(&ctx, out, out, N, 0, NULL);
+  assert(memcmp(out, in, sizeof(out)) == 0);
+
+  // empty input reports one idle worker, as the plain parallel transform does
+  assert(uuidv47_ctx_encode_parallel_numa(&ctx, in, out, 0, 2, stats) == 1 && stats[0].ids == 0);
+  assert(uuidv47_ctx_encode_parallel(&ctx, in, out, 0, 2, stats) == 1 && stats[0].ids == 0);
+
+  // node numbers past the mask are refused, not written out of bounds
+  assert(!uuidv47_numa_place(out, sizeof(out), UUIDV47_NUMA_MAX_NODES));
+  assert(!uuidv47_numa_place(out, sizeof(out), 100000));
+}
+
+static void test_facade_timestamp(void)
+{
+  uuidv47_key_t key = {.k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL};
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+
+  uuid128_t f;
+  assert(uuid_parse("2463c780-7fca-4def-8c3f-7b1a2c4d5e6f", &f));
+  assert(uuidv47_facade_timestamp_ms(&f, &ctx) == 0x018f2d9f9a2aULL);
+
+  enum { N = 70 };
+  uuid128_t v7[N], fac[N];
+  uint64_t ts[N];
+  for (int prf = 0; prf < 3; prf++)
+  {
+    if (!uuidv47_ctx_init_prf(&ctx, key, (uuidv47_prf_t)prf))
+      continue;
+    for (size_t i = 0; i < N; i++)
+      craft_v7(&v7[i], 0x0190a1b2c3d4ULL + (uint64_t)i * 1000003, (uint16_t)(i * 91), 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1) >> 2);
+    uuidv47_ctx_encode_batch(&ctx, v7, fac, N);
+    uuidv47_facade_timestamps_ms(fac, N, &ctx, ts);
+    for (int i = 0; i < N; i++)
+    {
+      assert(ts[i] == rd48be(v7[i].b));
+      assert(uuidv47_facade_timestamp_ms(&fac[i], &ctx) == ts[i]);
+    }
+  }
+}
+
+static void test_time_range_scan(void)
+{
+  enum { N = 203 };
+  uuid128_t v7[N];
+  for (size_t i = 0; i < N; i++)
+    craft_v7(&v7[i], 0x0190a1b2c000ULL + (uint64_t)((i * 7919) % 1000), (uint16_t)i, 0x0123456789abcdefULL ^ (uint64_t)i);
+
+  const uint64_t t0 = 0x0190a1b2c000ULL + 250, t1 = 0x0190a1b2c000ULL + 600;
+  uint64_t bitmap[(N + 63) / 64];
+  size_t idx[N];
+  size_t hits = uuidv47_time_filter_bitmap(v7, N, t0, t1, bitmap);
+  assert(uuidv47_time_filter_index(v7, N, t0, t1, idx) == hits);
+  size_t expect = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    uint64_t ts = rd48be(v7[i].b);
+    bool in = ts >= t0 && ts < t1;
+    assert(((bitmap[i / 64] >> (i % 64)) & 1) == (uint64_t)in);
+    if (in)
+      assert(idx[expect++] == i);
+  }
+  assert(expect == hits && hits > 0 && hits < N);
+  assert(uuidv47_time_filter_bitmap(v7, N, t1, t0, bitmap) == 0);
+  assert(uuidv47_time_filter_index(v7, N, 0, UINT64_MAX, idx) == N);
+
+  // Power-of-two and arbitrary bucket widths; the last bucket ends before some IDs.
+  const uint64_t widths[2] = {64, 100};
+  for (int w = 0; w < 2; w++)
+  {
+    uint64_t counts[9] = {0}, ref[9] = {0};
+    size_t counted = uuidv47_time_histogram(v7, N, t0, widths[w], counts, 9), ref_counted = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+      uint64_t ts = rd48be(v7[i].b);
+      if (ts >= t0 && (ts - t0) / widths[w] < 9)
+      {
+        ref[(ts - t0) / widths[w]]++;
+        ref_counted++;
+      }
+    }
+    assert(counted == ref_counted);
+    assert(memcmp(counts, ref, sizeof counts) == 0);
+  }
+}
+
+static int cmp_uuid_memcmp(const void *a, const void *b)
+{
+  return memcmp(a, b, sizeof(uuid128_t));
+}
+
+static void test_sort(void)
+{
+  enum { N = 20000 };
+  static uuid128_t ids[N], ref[N], work[N], scratch[N];
+  static size_t perm[N];
+  static uuidv47_sort_ent_t ents[2 * N];
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    // ~40 IDs per millisecond, one burst of 300 sharing a timestamp, some
+    // exact duplicates and a few non-v7 IDs
+    uint64_t ts = i < 300 ? 0x018f00000123ULL : 0x018f00000000ULL + (seed >> 40) % (N / 40);
+    craft_v7(&ids[i], ts, (uint16_t)(seed >> 20), seed >> 2);
+    if (i % 97 == 0 && i)
+      ids[i] = ids[i - 1];
+    if (i % 1001 == 0)
+      for (int b = 0; b < 16; b++)
+        ids[i].b[b] = (uint8_t)(seed >> (b * 4));
+  }
+  memcpy(ref, ids, sizeof ids);
+  qsort(ref, N, sizeof ref[0], cmp_uuid_memcmp);
+
+  const size_t sizes[4] = {0, 1, 40, N};
+  for (int s = 0; s < 4; s++)
+  {
+    size_t n = sizes[s];
+    memcpy(work, ids, n * sizeof ids[0]);
+    uuidv47_sort(work, n, scratch);
+    for (size_t i = 1; i < n; i++)
+      assert(uuidv47_cmp(&work[i - 1], &work[i]) <= 0);
+    uuidv47_sort_index(ids, n, perm, ents);
+    for (size_t i = 1; i < n; i++)
+    {
+      int c = uuidv47_cmp(&ids[perm[i - 1]], &ids[perm[i]]);
+      assert(c < 0 || (c == 0 && perm[i - 1] < perm[i]));
+    }
+  }
+  assert(memcmp(work, ref, sizeof ref) == 0);
+  for (size_t i = 0; i < N; i++)
+    assert(memcmp(&ids[perm[i]], &ref[i], sizeof ref[i]) == 0);
+
+  const unsigned threads[3] = {1, 3, 4};
+  for (int t = 0; t < 3; t++)
+  {
+    memcpy(work, ids, sizeof ids);
+    unsigned used = uuidv47_sort_parallel(work, N, scratch, threads[t]);
+    assert(used >= 1 && used <= threads[t]);
+    assert(memcmp(work, ref, sizeof ref) == 0);
+  }
+}
+
+static size_t naive_lower_bound(const uuid128_t *ids, size_t n, const uuid128_t *key)
+{
+  size_t i = 0;
+  while (i < n && memcmp(&ids[i], key, sizeof *key) < 0)
+    i++;
+  return i;
+}
+
+static void test_sorted_lookup(void)
+{
+  enum { N = 5000 };
+  static uuid128_t ids[N], scratch[N];
+  static size_t slots[N + 1];
+  uint64_t seed = 0x243f6a8885a308d3ULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    // uniform over ~5 s, plus a 400-ID burst in one millisecond
+    uint64_t ts = i < 400 ? 0x018f00001000ULL : 0x018f00000000ULL + (seed >> 33) % 5000;
+    craft_v7(&ids[i], ts, (uint16_t)(seed >> 20), seed >> 2);
+    if (i % 50 == 0 && i)
+      ids[i] = ids[i - 1];
+  }
+  uuidv47_sort(ids, N, scratch);
+
+  const size_t sizes[4] = {0, 1, 300, N};
+  for (int s = 0; s < 4; s++)
+  {
+    size_t n = sizes[s];
+    uuidv47_lookup_t lk;
+    uuidv47_lookup_init(&lk, ids, n, slots, uuidv47_lookup_slots(n));
+    uuidv47_lookup_t tiny; // one slot: everything goes through interpolation
+    uuidv47_lookup_init(&tiny, ids, n, slots + N / 2, 1);
+    for (int q = 0; q < 2000; q++)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      uuid128_t key;
+      if (n && q % 2)
+        key = ids[(seed >> 33) % n];
+      else
+        craft_v7(&key, 0x018efffffff0ULL + (seed >> 33) % 5100, (uint16_t)(seed >> 20), seed >> 2);
+      size_t want = naive_lower_bound(ids, n, &key), pos = SIZE_MAX;
+      assert(uuidv47_interp_lower_bound(ids, n, &key) == want);
+      assert(uuidv47_lookup_lower_bound(&lk, &key) == want);
+      assert(uuidv47_lookup_lower_bound(&tiny, &key) == want);
+      bool hit = want < n && memcmp(&ids[want], &key, sizeof key) == 0;
+      assert(uuidv47_lookup_find(&lk, &key, &pos) == hit);
+      assert(!hit || pos == want);
+    }
+    const uint64_t ranges[4][2] = {
+        {0x018f00000100ULL, 0x018f00000200ULL}, {0x018f00001000ULL, 0x018f00001001ULL}, {0, UINT64_MAX}, {5, 3}};
+    for (int r = 0; r < 4; r++)
+    {
+      size_t first = SIZE_MAX, count = uuidv47_lookup_time_range(&lk, ranges[r][0], ranges[r][1], &first);
+      size_t want_first = n, want_count = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        uint64_t ts = rd48be(ids[i].b);
+        if (ts >= ranges[r][0] && ts < ranges[r][1])
+        {
+          want_first = want_count ? want_first : i;
+          want_count++;
+        }
+      }
+      assert(count == want_count);
+      assert(count == 0 || first == want_first);
+    }
+  }
+}
+
+static void test_idxfile(void)
+{
+  enum { N = 3000 };
+  static uuid128_t ids[N], scratch[N];
+  uint64_t seed = 0xb7e151628aed2a6bULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    // 20 s with a 7 s hole, a 300-ID burst in one millisecond, some duplicates
+    uint64_t ms = (seed >> 33) % 13000;
+    uint64_t ts = i < 300 ? 0x018f00000500ULL : 0x018f00000000ULL + (ms < 6000 ? ms : ms + 7000);
+    craft_v7(&ids[i], ts, (uint16_t)(seed >> 20), seed >> 2);
+    if (i % 40 == 0 && i)
+      ids[i] = ids[i - 1];
+  }
+  char path[] = "/tmp/uuidv47_idx_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+
+  uuidv47_idxfile_t f;
+  assert(!uuidv47_idxfile_write(path, ids, N)); // unsorted
+  uuidv47_sort(ids, N, scratch);
+  const size_t sizes[3] = {0, 1, N};
+  for (int s = 0; s < 3; s++)
+  {
+    size_t n = sizes[s];
+    assert(uuidv47_idxfile_write(path, ids, n));
+    assert(uuidv47_idxfile_open(&f, path));
+    assert(f.n == n && (n == 0 || memcmp(f.ids, ids, n * sizeof ids[0]) == 0));
+    assert(n == 0 || (f.ts_min == rd48be(ids[0].b) && f.ts_max == rd48be(ids[n - 1].b)));
+    for (int q = 0; q < 1000; q++)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      uuid128_t key;
+      if (n && q % 2)
+        key = ids[(seed >> 33) % n];
+      else
+        craft_v7(&key, 0x018efffffc00ULL + (seed >> 33) % 22000, (uint16_t)(seed >> 20), seed >> 2);
+      size_t want = naive_lower_bound(ids, n, &key), pos = SIZE_MAX;
+      assert(uuidv47_idxfile_lower_bound(&f, &key) == want);
+      bool hit = want < n && memcmp(&ids[want], &key, sizeof key) == 0;
+      assert(uuidv47_idxfile_find(&f, &key, &pos) == hit);
+      assert(!hit || pos == want);
+    }
+    const uint64_t ranges[4][2] = {
+        {0x018f00000000ULL, 0x018f000003e8ULL}, {0x018f00001b58ULL, 0x018f00003000ULL}, {0, UINT64_MAX}, {9, 2}};
+    for (int r = 0; r < 4; r++)
+    {
+      size_t first = SIZE_MAX, count = uuidv47_idxfile_time_range(&f, ranges[r][0], ranges[r][1], &first);
+      size_t want_first = n, want_count = 0;
+      for (size_t i = 0; i < n; i++)
+        if (rd48be(ids[i].b) >= ranges[r][0] && rd48be(ids[i].b) < ranges[r][1])
+          want_first = want_count++ ? want_first : i;
+      assert(count == want_count && (count == 0 || first == want_first));
+    }
+    uuidv47_idxfile_close(&f);
+  }
+
+  // a corrupt seconds table is rejected: an index past n, a second that goes
+  // backwards, an index that goes backwards, a first entry not at record 0,
+  // and an index repeated by the next second
+  const struct { size_t off; uint64_t v; } patches[5] = {
+      {64 + 16 * N + 16 + 8, (uint64_t)N + 1000}, {64 + 16 * N + 16, 0}, {64 + 16 * N + 32 + 8, 0},
+      {64 + 16 * N + 8, 1}, {64 + 16 * N + 16 + 8, 0}};
+  for (int c = 0; c < 5; c++)
+  {
+    assert(uuidv47_idxfile_write(path, ids, N));
+    FILE *pf = fopen(path, "r+b");
+    uint8_t le[8];
+    wr64le(le, patches[c].v);
+    assert(pf && fseek(pf, (long)patches[c].off, SEEK_SET) == 0 && fwrite(le, 1, 8, pf) == 8 && fclose(pf) == 0);
+    assert(!uuidv47_idxfile_open(&f, path));
+  }
+
+  // a truncated file and a bad magic are rejected
+  assert(uuidv47_idxfile_write(path, ids, N));
+  assert(truncate(path, 64 + 16 * N) == 0);
+  assert(!uuidv47_idxfile_open(&f, path));
+  FILE *fp = fopen(path, "wb");
+  assert(fp && fwrite("UUIDV47X", 1, 8, fp) == 8 && fwrite(scratch, 1, 56, fp) == 56 && fclose(fp) == 0);
+  assert(!uuidv47_idxfile_open(&f, path));
+  remove(path);
+}
+
+static void test_block_codec(void)
+{
+  enum { N = 1000 };
+  static uuid128_t ids[N], back[N];
+  static uint8_t buf[N * 20];
+  uint64_t seed = 0x3c6ef372fe94f82bULL, ts = 0x018f2d9f9a2aULL;
+  for (int i = 0; i < N; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    ts += (seed >> 60) < 10 ? 0 : (seed >> 40) % 7; // runs of equal timestamps and small gaps
+    craft_v7(&ids[i], ts, (uint16_t)(seed >> 20), seed >> 2);
+  }
+  size_t n_out = 0, len = uuidv47_blocks_encode(ids, N, buf);
+  assert(len > 0 && len <= uuidv47_block_bound(N) && len < 11 * N); // 16 bytes raw
+  assert(uuidv47_blocks_decode(buf, len, back, N, &n_out) == len && n_out == N);
+  assert(memcmp(back, ids, sizeof ids) == 0);
+
+  // block by block, as a stream reader would
+  size_t used = 0, got = 0;
+  while (used < len)
+  {
+    size_t k, m;
+    assert((k = uuidv47_block_decode(&buf[used], len - used, &back[got], &m)) > 0);
+    used += k;
+    got += m;
+  }
+  assert(got == N);
+  // out fills up at a block boundary; a cut inside a block stops before it
+  assert(uuidv47_blocks_decode(buf, len, back, 300, &n_out) < len && n_out == 256);
+  assert(uuidv47_blocks_decode(buf, len - 1, back, N, &n_out) < len - 1 && n_out == N - N % UUIDV47_BLOCK_IDS);
+
+  // unordered timestamps (zigzag), one ID, and identical timestamps
+  uuid128_t mixed[5];
+  const uint64_t tss[5] = {0x018f00000100ULL, 0x018f00000000ULL, 0xFFFFFFFFFFFFULL, 0, 0x018f00000100ULL};
+  for (size_t i = 0; i < 5; i++)
+    craft_v7(&mixed[i], tss[i], 0x0FFF, (1ULL << 62) - 1 - (uint64_t)i);
+  const size_t counts[3] = {5, 1, 2};
+  const size_t offs[3] = {0, 2, 0};
+  for (int c = 0; c < 3; c++)
+  {
+    size_t k = uuidv47_block_encode(&mixed[offs[c]], counts[c], buf);
+    assert(k > 0 && uuidv47_block_decode(buf, k, back, &n_out) == k && n_out == counts[c]);
+    assert(memcmp(back, &mixed[offs[c]], counts[c] * sizeof back[0]) == 0);
+  }
+  uuid128_t same[3] = {ids[0], ids[0], ids[0]};
+  size_t k = uuidv47_block_encode(same, 3, buf);
+  assert(buf[1] == 0 && k == uuidv47_block_size(3, 0));
+
+  // non-v7 input is refused; malformed blocks are rejected
+  uuid128_t v4 = ids[0];
+  set_version(&v4, 4);
+  assert(uuidv47_block_encode(&v4, 1, buf) == 0);
+  assert(uuidv47_blocks_encode(&v4, 1, buf) == 0);
+  k = uuidv47_block_encode(ids, 4, buf);
+  buf[1] = 50;
+  assert(uuidv47_block_decode(buf, k, back, &n_out) == 0);
+  k = uuidv47_block_encode(mixed, 2, buf); // deltas: zigzag, timestamp goes down by 0x100
+  wr48be(&buf[2], 0x10);                   // so a base of 0x10 underflows
+  assert(uuidv47_block_decode(buf, k, back, &n_out) == 0);
+}
+
 int main(void)
 {
   test_rd_wr_48();
   test_uuid_parse_format_roundtrip();
   test_version_variant();
   test_siphash_switch_and_vectors_subset();
+  test_siphash24_10_fixed_length();
   test_build_sip_input_stability();
   test_encode_decode_roundtrip();
+  test_batch_matches_scalar();
+  test_simd_kernels_match_reference();
+  test_ctx_matches_key_api();
+  test_bitsliced_matches_scalar();
+  test_prf_modes_vectors();
+  test_aes_prf();
+  test_uuid_parse_strict_and_simd();
+  test_uuid_format_variants();
+  test_text_lines();
+  test_fused_string_transform();
+  test_compact_encodings();
+  test_uuid_parse_any_forms();
+  test_inplace_transform();
+  test_strided_transform();
+  test_soa_layout();
+  test_facade_timestamp();
+  test_time_range_scan();
+  test_sort();
+  test_sorted_lookup();
+  test_idxfile();
+  test_block_codec();
+  test_parallel_transform();
+  test_parallel_numa();
   puts("All tests passed.");
   return 0;
 }
@@ -9,6 +9,62 @@
 #include <string.h>
 #include <stdbool.h>
 
+// Member alignment that also compiles as C++ and pre-C11 GNU C.
+#if defined(__cplusplus)
+#define UUIDV47_ALIGN(n) alignas(n)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define UUIDV47_ALIGN(n) _Alignas(n)
+#else
+#define UUIDV47_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+// x86-64 SIMD kernels (GCC/Clang) are compiled per function with target
+// attributes and picked at runtime, so the header still builds for baseline
+// x86-64. Define UUIDV47_NO_SIMD to compile them out entirely.
+#if !defined(UUIDV47_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UUIDV47_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define UUIDV47_X86_SIMD 0
+#endif
+
+// Opt-in parallel batch API (pthreads); link with -pthread. It uses C11
+// <stdatomic.h>, so it needs a C11 compiler (not C99, not C++).
+#if defined(UUIDV47_ENABLE_THREADS) && UUIDV47_ENABLE_THREADS
+#if defined(__cplusplus) || !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L || defined(__STDC_NO_ATOMICS__)
+#error "UUIDV47_ENABLE_THREADS needs C11 with <stdatomic.h>"
+#endif
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+// NUMA placement on top of it (Linux; raw syscalls, no libnuma). The including
+// file must define _GNU_SOURCE before its first #include.
+#if defined(UUIDV47_ENABLE_THREADS) && UUIDV47_ENABLE_THREADS && defined(UUIDV47_ENABLE_NUMA) && \
+    UUIDV47_ENABLE_NUMA && defined(__linux__)
+#define UUIDV47_NUMA 1
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#else
+#define UUIDV47_NUMA 0
+#endif
+// Opt-in memory-mapped index files (POSIX). The including file must define
+// _POSIX_C_SOURCE 200809L or _GNU_SOURCE before its first #include.
+#if defined(UUIDV47_ENABLE_MMAP) && UUIDV47_ENABLE_MMAP && (defined(__unix__) || defined(__APPLE__))
+#define UUIDV47_MMAP 1
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define UUIDV47_MMAP 0
+#endif
+
 typedef struct uuid128
 {
   uint8_t b[16];
@@ -18,6 +74,26 @@ typedef struct uuidv47_key
   uint64_t k0, k1; // SipHash 128-bit key
 } uuidv47_key_t;
 
+// PRF used to derive the 48-bit timestamp mask. Encode and decode must use the
+// same one; it is fixed when a uuidv47_ctx_t is built and stored in it.
+typedef enum uuidv47_prf
+{
+  UUIDV47_PRF_SIPHASH24 = 0, // default; same results as the uuidv47_key_t API
+  UUIDV47_PRF_SIPHASH13 = 1, // opt-in: half the rounds, weaker margin
+  UUIDV47_PRF_AES128 = 2,    // opt-in: one AES-128 block; x86-64 with AES-NI only
+} uuidv47_prf_t;
+
+// Precomputed per-key state (see uuidv47_ctx_init). Treat as opaque: build it
+// once per key and pass it by pointer. Aligned to a cache line so the hot
+// state never straddles two lines.
+typedef struct uuidv47_ctx
+{
+  UUIDV47_ALIGN(64) uint64_t v[4]; // SipHash initial state v0..v3 for the key
+  uint32_t prf;               // uuidv47_prf_t the masks are derived with
+  uint8_t crounds, drounds;   // SipHash compression/finalization rounds for prf
+  UUIDV47_ALIGN(16) uint8_t aes_rk[176]; // AES-128 round keys, 11 x 16 bytes (UUIDV47_PRF_AES128)
+} uuidv47_ctx_t;
+
 
 static inline uint64_t rd64le(const void *p)
 {
@@ -26,6 +102,11 @@ static inline uint64_t rd64le(const void *p)
          ((uint64_t)x[3] << 24) | ((uint64_t)x[4] << 32) | ((uint64_t)x[5] << 40) |
          ((uint64_t)x[6] << 48) | ((uint64_t)x[7] << 56);
 }
+static inline void wr64le(uint8_t dst[8], uint64_t v)
+{
+  for (int i = 0; i < 8; i++)
+    dst[i] = (uint8_t)(v >> (8 * i));
+}
 static inline void wr48be(uint8_t dst[6], uint64_t v48)
 {
   dst[0] = (uint8_t)(v48 >> 40);
@@ -40,6 +121,16 @@ static inline uint64_t rd48be(const uint8_t src[6])
   return ((uint64_t)src[0] << 40) | ((uint64_t)src[1] << 32) | ((uint64_t)src[2] << 24) |
          ((uint64_t)src[3] << 16) | ((uint64_t)src[4] << 8) | ((uint64_t)src[5] << 0);
 }
+static inline uint64_t rd64be(const uint8_t src[8])
+{
+  return ((uint64_t)rd48be(src) << 16) | ((uint64_t)src[6] << 8) | (uint64_t)src[7];
+}
+static inline void wr64be(uint8_t dst[8], uint64_t v)
+{
+  wr48be(dst, v >> 16);
+  dst[6] = (uint8_t)(v >> 8);
+  dst[7] = (uint8_t)v;
+}
 
 // SipHash-2-4 (reference)
 #define ROTL64(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
@@ -139,6 +230,160 @@ static inline uint64_t siphash24(const uint8_t *in, size_t inlen, uint64_t k0, u
   }
   return v0 ^ v1 ^ v2 ^ v3;
 }
+
+// SipHash-2-4 specialized for a 10-byte message given as its two words:
+// m0 = bytes 0..7 (LE), m1 = bytes 8..9 | (10 << 56). No loop, no tail switch.
+// sip_init_state does the key setup on its own so it can be done once per key.
+#define SIPROUND(v0, v1, v2, v3) \
+  do                             \
+  {                              \
+    v0 += v1;                    \
+    v2 += v3;                    \
+    v1 = ROTL64(v1, 13);         \
+    v3 = ROTL64(v3, 16);         \
+    v1 ^= v0;                    \
+    v3 ^= v2;                    \
+    v0 = ROTL64(v0, 32);         \
+    v2 += v1;                    \
+    v0 += v3;                    \
+    v1 = ROTL64(v1, 17);         \
+    v3 = ROTL64(v3, 21);         \
+    v1 ^= v2;                    \
+    v3 ^= v0;                    \
+    v2 = ROTL64(v2, 32);         \
+  } while (0)
+static inline void sip_init_state(uint64_t v[4], uint64_t k0, uint64_t k1)
+{
+  v[0] = 0x736f6d6570736575ULL ^ k0;
+  v[1] = 0x646f72616e646f6dULL ^ k1;
+  v[2] = 0x6c7967656e657261ULL ^ k0;
+  v[3] = 0x7465646279746573ULL ^ k1;
+}
+
+// Same, starting from a precomputed initial state (sip_init_state).
+static inline uint64_t siphash24_10_state(const uint64_t init[4], uint64_t m0, uint64_t m1)
+{
+  uint64_t v0 = init[0], v1 = init[1], v2 = init[2], v3 = init[3];
+
+  v3 ^= m0;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= m0;
+
+  v3 ^= m1;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= m1;
+
+  v2 ^= 0xff;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// SipHash-1-3 variant of siphash24_10_state (UUIDV47_PRF_SIPHASH13).
+static inline uint64_t siphash13_10_state(const uint64_t init[4], uint64_t m0, uint64_t m1)
+{
+  uint64_t v0 = init[0], v1 = init[1], v2 = init[2], v3 = init[3];
+
+  v3 ^= m0;
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= m0;
+
+  v3 ^= m1;
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= m1;
+
+  v2 ^= 0xff;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static inline uint64_t siphash24_10(uint64_t m0, uint64_t m1, uint64_t k0, uint64_t k1)
+{
+  uint64_t v[4];
+  sip_init_state(v, k0, k1);
+  return siphash24_10_state(v, m0, m1);
+}
+
+// Four independent 10-byte messages at once without ISA-specific code. The
+// lanes share no data, so the four add/rotate/xor chains that are strictly
+// serial in siphash24_10_state overlap: GCC/Clang vector extensions lower
+// this to whatever the baseline target has (SSE2, NEON, ...); other compilers
+// get four interleaved scalar states. Used when no x86 SIMD kernel applies.
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint64_t sip_u64x4 __attribute__((vector_size(32)));
+#define SIPROUND_X4(v0, v1, v2, v3) SIPROUND(v0, v1, v2, v3)
+#else
+typedef struct
+{
+  uint64_t x[4];
+} sip_u64x4;
+#define SIPROUND_X4(v0, v1, v2, v3)                     \
+  do                                                    \
+  {                                                     \
+    for (int j_ = 0; j_ < 4; j_++)                      \
+      SIPROUND(v0.x[j_], v1.x[j_], v2.x[j_], v3.x[j_]); \
+  } while (0)
+#endif
+static inline void siphash_10_x4_portable(const uint64_t init[4], int crounds, int drounds,
+                                          const uint64_t m0[4], const uint64_t m1[4], uint64_t out[4])
+{
+  sip_u64x4 v0, v1, v2, v3, w0, w1, h;
+  uint64_t bcast[4][4];
+  for (int k = 0; k < 4; k++)
+    for (int j = 0; j < 4; j++)
+      bcast[k][j] = init[k];
+  memcpy(&v0, bcast[0], sizeof(v0));
+  memcpy(&v1, bcast[1], sizeof(v1));
+  memcpy(&v2, bcast[2], sizeof(v2));
+  memcpy(&v3, bcast[3], sizeof(v3));
+  memcpy(&w0, m0, sizeof(w0));
+  memcpy(&w1, m1, sizeof(w1));
+
+#if defined(__GNUC__) || defined(__clang__)
+  v3 ^= w0;
+  for (int r = 0; r < crounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  v0 ^= w0;
+  v3 ^= w1;
+  for (int r = 0; r < crounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  v0 ^= w1;
+  v2 ^= 0xff;
+  for (int r = 0; r < drounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  h = v0 ^ v1 ^ v2 ^ v3;
+#else
+  for (int j = 0; j < 4; j++)
+    v3.x[j] ^= w0.x[j];
+  for (int r = 0; r < crounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  for (int j = 0; j < 4; j++)
+  {
+    v0.x[j] ^= w0.x[j];
+    v3.x[j] ^= w1.x[j];
+  }
+  for (int r = 0; r < crounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  for (int j = 0; j < 4; j++)
+  {
+    v0.x[j] ^= w1.x[j];
+    v2.x[j] ^= 0xff;
+  }
+  for (int r = 0; r < drounds; r++)
+    SIPROUND_X4(v0, v1, v2, v3);
+  for (int j = 0; j < 4; j++)
+    h.x[j] = v0.x[j] ^ v1.x[j] ^ v2.x[j] ^ v3.x[j];
+#endif
+  memcpy(out, &h, sizeof(h));
+}
+#undef SIPROUND_X4
+#undef SIPROUND
 #undef ROTL64
 
 // Version/variant helpers
@@ -159,13 +404,27 @@ static inline void build_sip_input_from_v7(const uuid128_t *u, uint8_t msg[10])
 // The same function works for the façade, because fields at [6] low nibble,
 // [7], [8]&0x3F and [9..15] are identical before/after the transform.
 
+// The two SipHash words of that message, read straight from the UUID bytes:
+// bytes 6..13 with the version nibble and variant bits cleared, then 14..15
+// plus the length byte (10) in the top 8 bits.
+static inline void sip_words_from_uuid(const uuid128_t *u, uint64_t *m0, uint64_t *m1)
+{
+  *m0 = rd64le(&u->b[6]) & 0xFFFFFFFFFF3FFF0FULL;
+  *m1 = (uint64_t)u->b[14] | ((uint64_t)u->b[15] << 8) | (10ULL << 56);
+}
+
+static inline uint64_t uuidv47_mask48(const uuid128_t *u, uint64_t k0, uint64_t k1)
+{
+  uint64_t m0, m1;
+  sip_words_from_uuid(u, &m0, &m1);
+  return siphash24_10(m0, m1, k0, k1) & 0x0000FFFFFFFFFFFFULL;
+}
+
 // Core encode/decode
 static inline uuid128_t uuidv47_encode_v4facade(uuid128_t v7, uuidv47_key_t key)
 {
   // 1) mask = SipHash24(key, v7.random74bits) -> take low 48 bits
-  uint8_t sipmsg[10];
-  build_sip_input_from_v7(&v7, sipmsg);
-  uint64_t mask48 = siphash24(sipmsg, sizeof(sipmsg), key.k0, key.k1) & 0x0000FFFFFFFFFFFFULL;
+  uint64_t mask48 = uuidv47_mask48(&v7, key.k0, key.k1);
 
   // 2) encTS = ts ^ mask
   uint64_t ts48 = rd48be(&v7.b[0]);
@@ -182,9 +441,7 @@ static inline uuid128_t uuidv47_encode_v4facade(uuid128_t v7, uuidv47_key_t key)
 static inline uuid128_t uuidv47_decode_v4facade(uuid128_t v4facade, uuidv47_key_t key)
 {
   // 1) rebuild same Sip input from façade (identical bytes)
-  uint8_t sipmsg[10];
-  build_sip_input_from_v7(&v4facade, sipmsg);
-  uint64_t mask48 = siphash24(sipmsg, sizeof(sipmsg), key.k0, key.k1) & 0x0000FFFFFFFFFFFFULL;
+  uint64_t mask48 = uuidv47_mask48(&v4facade, key.k0, key.k1);
 
   // 2) ts = encTS ^ mask
   uint64_t encTS = rd48be(&v4facade.b[0]);
@@ -198,48 +455,2801 @@ static inline uuid128_t uuidv47_decode_v4facade(uuid128_t v4facade, uuidv47_key_
   return out;
 }
 
-// String I/O (canonical 8-4-4-4-12)
-static inline int hexval(int c)
+// AES-128 mask PRF (UUIDV47_PRF_AES128)
+//
+// mask48 = low 48 bits of AES-128 under K = k0 || k1 (little-endian bytes) of
+// the block m0 || m1, i.e. the 74 random bits plus the length byte laid out
+// exactly like the SipHash message words. Requires AES-NI: there is on purpose
+// no table-based software AES (it leaks the key through cache timing), so
+// uuidv47_ctx_init_prf refuses this PRF on CPUs without it.
+#if UUIDV47_X86_SIMD
+__attribute__((target("aes"))) static inline __m128i aes128_expand_step(__m128i k, __m128i gen)
 {
-  if ('0' <= c && c <= '9')
-    return c - '0';
-  if ('a' <= c && c <= 'f')
-    return c - 'a' + 10;
-  if ('A' <= c && c <= 'F')
-    return c - 'A' + 10;
-  return -1;
+  gen = _mm_shuffle_epi32(gen, _MM_SHUFFLE(3, 3, 3, 3));
+  k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+  k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+  k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+  return _mm_xor_si128(k, gen);
 }
+#define AES128_EXPAND(k, rcon) aes128_expand_step((k), _mm_aeskeygenassist_si128((k), (rcon)))
 
-static inline bool uuid_parse(const char *s, uuid128_t *out)
+__attribute__((target("aes"))) static inline void aes128_expand_key_aesni(uint8_t rk[176], uint64_t k0, uint64_t k1)
 {
-  // expects xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
-  int idxs[32] = {0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, 16, 17, 19, 20, 21, 22, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35};
-  uint8_t b[16] = {0};
-  for (int i = 0; i < 16; i++)
+  __m128i k[11];
+  k[0] = _mm_set_epi64x((long long)k1, (long long)k0);
+  k[1] = AES128_EXPAND(k[0], 0x01);
+  k[2] = AES128_EXPAND(k[1], 0x02);
+  k[3] = AES128_EXPAND(k[2], 0x04);
+  k[4] = AES128_EXPAND(k[3], 0x08);
+  k[5] = AES128_EXPAND(k[4], 0x10);
+  k[6] = AES128_EXPAND(k[5], 0x20);
+  k[7] = AES128_EXPAND(k[6], 0x40);
+  k[8] = AES128_EXPAND(k[7], 0x80);
+  k[9] = AES128_EXPAND(k[8], 0x1B);
+  k[10] = AES128_EXPAND(k[9], 0x36);
+  for (int r = 0; r < 11; r++)
+    _mm_storeu_si128((__m128i *)(void *)&rk[16 * r], k[r]);
+}
+#undef AES128_EXPAND
+
+__attribute__((target("aes"))) static inline __m128i aes128_encrypt_aesni(const uint8_t rk[176], __m128i b)
+{
+  b = _mm_xor_si128(b, _mm_load_si128((const __m128i *)(const void *)&rk[0]));
+  for (int r = 1; r < 10; r++)
+    b = _mm_aesenc_si128(b, _mm_load_si128((const __m128i *)(const void *)&rk[16 * r]));
+  return _mm_aesenclast_si128(b, _mm_load_si128((const __m128i *)(const void *)&rk[16 * 10]));
+}
+
+static inline bool uuidv47_cpu_has_aesni(void)
+{
+  return __builtin_cpu_supports("aes") && __builtin_cpu_supports("ssse3");
+}
+#endif // UUIDV47_X86_SIMD
+
+// Key context
+//
+// uuidv47_ctx_init runs the SipHash key setup once; the ctx_* functions then
+// skip it on every call. Results are identical to the uuidv47_key_t API.
+// uuidv47_ctx_init_prf selects another mask PRF (false if `prf` is unknown or
+// not supported on this CPU); façades made with one PRF only decode with a
+// context built for the same one.
+static inline bool uuidv47_ctx_init_prf(uuidv47_ctx_t *ctx, uuidv47_key_t key, uuidv47_prf_t prf)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  switch (prf)
   {
-    int h = hexval(s[idxs[i * 2]]);
-    int l = hexval(s[idxs[i * 2 + 1]]);
-    if (h < 0 || l < 0)
+  case UUIDV47_PRF_SIPHASH24:
+    ctx->crounds = 2;
+    ctx->drounds = 4;
+    break;
+  case UUIDV47_PRF_SIPHASH13:
+    ctx->crounds = 1;
+    ctx->drounds = 3;
+    break;
+#if UUIDV47_X86_SIMD
+  case UUIDV47_PRF_AES128:
+    if (!uuidv47_cpu_has_aesni())
       return false;
-    b[i] = (uint8_t)((h << 4) | l);
+    aes128_expand_key_aesni(ctx->aes_rk, key.k0, key.k1);
+    break;
+#endif
+  default:
+    return false;
   }
-  memcpy(out->b, b, 16);
+  sip_init_state(ctx->v, key.k0, key.k1);
+  ctx->prf = (uint32_t)prf;
   return true;
 }
 
-static inline void uuid_format(const uuid128_t *u, char out[37])
+static inline void uuidv47_ctx_init(uuidv47_ctx_t *ctx, uuidv47_key_t key)
 {
-  static const char *hexd = "0123456789abcdef";
-  int dpos[4] = {4, 6, 8, 10};
-  int j = 0;
-  for (int i = 0; i < 16; i++)
+  (void)uuidv47_ctx_init_prf(ctx, key, UUIDV47_PRF_SIPHASH24);
+}
+
+static inline uuidv47_prf_t uuidv47_ctx_prf(const uuidv47_ctx_t *ctx)
+{
+  return (uuidv47_prf_t)ctx->prf;
+}
+
+static inline uint64_t uuidv47_ctx_mask48_words(const uuidv47_ctx_t *ctx, uint64_t m0, uint64_t m1)
+{
+  uint64_t h;
+  if (ctx->prf == UUIDV47_PRF_SIPHASH13)
+    h = siphash13_10_state(ctx->v, m0, m1);
+#if UUIDV47_X86_SIMD
+  else if (ctx->prf == UUIDV47_PRF_AES128)
+    h = (uint64_t)_mm_cvtsi128_si64(aes128_encrypt_aesni(ctx->aes_rk, _mm_set_epi64x((long long)m1, (long long)m0)));
+#endif
+  else
+    h = siphash24_10_state(ctx->v, m0, m1);
+  return h & 0x0000FFFFFFFFFFFFULL;
+}
+static inline uint64_t uuidv47_ctx_mask48(const uuidv47_ctx_t *ctx, const uuid128_t *u)
+{
+  uint64_t m0, m1;
+  sip_words_from_uuid(u, &m0, &m1);
+  return uuidv47_ctx_mask48_words(ctx, m0, m1);
+}
+
+static inline void uuidv47_apply_mask48(uuid128_t *u, uint64_t mask48, int ver)
+{
+  wr48be(&u->b[0], rd48be(&u->b[0]) ^ mask48);
+  set_version(u, ver);
+  set_variant_rfc4122(u);
+}
+
+static inline uuid128_t uuidv47_ctx_encode(const uuidv47_ctx_t *ctx, const uuid128_t *v7)
+{
+  uuid128_t out = *v7;
+  uuidv47_apply_mask48(&out, uuidv47_ctx_mask48(ctx, v7), 4);
+  return out;
+}
+
+static inline uuid128_t uuidv47_ctx_decode(const uuidv47_ctx_t *ctx, const uuid128_t *v4facade)
+{
+  uuid128_t out = *v4facade;
+  uuidv47_apply_mask48(&out, uuidv47_ctx_mask48(ctx, v4facade), 7);
+  return out;
+}
+
+// Batch encode/decode
+//
+// Array variants of uuidv47_encode_v4facade/uuidv47_decode_v4facade. `in` and
+// `out` may be the same array (in-place), but must not otherwise overlap.
+// On x86-64 (GCC/Clang) the SipHash work for eight IDs (AVX-512F/VL) or four
+// IDs (AVX2) is done at once in vector registers, picked at runtime from what
+// the CPU supports. Elsewhere four interleaved scalar streams are used; the
+// last n % 4 IDs run the single-stream path.
+
+#if UUIDV47_X86_SIMD
+#define SIP256_ROTL(x, b) _mm256_or_si256(_mm256_slli_epi64((x), (b)), _mm256_srli_epi64((x), 64 - (b)))
+#define SIP256_ROTL16(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8(6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13, \
+                                                                   6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13))
+#define SIP256_ROTL32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define SIP256_ROUND(v0, v1, v2, v3)  \
+  do                                  \
+  {                                   \
+    v0 = _mm256_add_epi64(v0, v1);    \
+    v2 = _mm256_add_epi64(v2, v3);    \
+    v1 = SIP256_ROTL(v1, 13);         \
+    v3 = SIP256_ROTL16(v3);           \
+    v1 = _mm256_xor_si256(v1, v0);    \
+    v3 = _mm256_xor_si256(v3, v2);    \
+    v0 = SIP256_ROTL32(v0);           \
+    v2 = _mm256_add_epi64(v2, v1);    \
+    v0 = _mm256_add_epi64(v0, v3);    \
+    v1 = SIP256_ROTL(v1, 17);         \
+    v3 = SIP256_ROTL(v3, 21);         \
+    v1 = _mm256_xor_si256(v1, v2);    \
+    v3 = _mm256_xor_si256(v3, v0);    \
+    v2 = SIP256_ROTL32(v2);           \
+  } while (0)
+
+// SipHash-c-d of four 10-byte messages, given as their two message words,
+// from the initial state `init` (sip_init_state).
+__attribute__((target("avx2"))) static inline void siphash_10_x4_avx2(const uint64_t init[4], int crounds, int drounds,
+                                                                       const uint64_t m0[4], const uint64_t m1[4],
+                                                                       uint64_t out[4])
+{
+  __m256i v0 = _mm256_set1_epi64x((long long)init[0]);
+  __m256i v1 = _mm256_set1_epi64x((long long)init[1]);
+  __m256i v2 = _mm256_set1_epi64x((long long)init[2]);
+  __m256i v3 = _mm256_set1_epi64x((long long)init[3]);
+  const __m256i w0 = _mm256_loadu_si256((const __m256i *)(const void *)m0);
+  const __m256i w1 = _mm256_loadu_si256((const __m256i *)(const void *)m1);
+
+  v3 = _mm256_xor_si256(v3, w0);
+  for (int r = 0; r < crounds; r++)
+    SIP256_ROUND(v0, v1, v2, v3);
+  v0 = _mm256_xor_si256(v0, w0);
+
+  v3 = _mm256_xor_si256(v3, w1);
+  for (int r = 0; r < crounds; r++)
+    SIP256_ROUND(v0, v1, v2, v3);
+  v0 = _mm256_xor_si256(v0, w1);
+
+  v2 = _mm256_xor_si256(v2, _mm256_set1_epi64x(0xff));
+  for (int r = 0; r < drounds; r++)
+    SIP256_ROUND(v0, v1, v2, v3);
+
+  __m256i h = _mm256_xor_si256(_mm256_xor_si256(v0, v1), _mm256_xor_si256(v2, v3));
+  _mm256_storeu_si256((__m256i *)(void *)out, h);
+}
+
+#define SIP512_ROUND(v0, v1, v2, v3)  \
+  do                                  \
+  {                                   \
+    v0 = _mm512_add_epi64(v0, v1);    \
+    v2 = _mm512_add_epi64(v2, v3);    \
+    v1 = _mm512_rol_epi64(v1, 13);    \
+    v3 = _mm512_rol_epi64(v3, 16);    \
+    v1 = _mm512_xor_si512(v1, v0);    \
+    v3 = _mm512_xor_si512(v3, v2);    \
+    v0 = _mm512_rol_epi64(v0, 32);    \
+    v2 = _mm512_add_epi64(v2, v1);    \
+    v0 = _mm512_add_epi64(v0, v3);    \
+    v1 = _mm512_rol_epi64(v1, 17);    \
+    v3 = _mm512_rol_epi64(v3, 21);    \
+    v1 = _mm512_xor_si512(v1, v2);    \
+    v3 = _mm512_xor_si512(v3, v0);    \
+    v2 = _mm512_rol_epi64(v2, 32);    \
+  } while (0)
+
+// Same as siphash_10_x4_avx2 for eight messages; ROTL64 is a single vprolq.
+__attribute__((target("avx512f,avx512vl"))) static inline void siphash_10_x8_avx512(const uint64_t init[4], int crounds,
+                                                                                    int drounds, const uint64_t m0[8],
+                                                                                    const uint64_t m1[8], uint64_t out[8])
+{
+  __m512i v0 = _mm512_set1_epi64((long long)init[0]);
+  __m512i v1 = _mm512_set1_epi64((long long)init[1]);
+  __m512i v2 = _mm512_set1_epi64((long long)init[2]);
+  __m512i v3 = _mm512_set1_epi64((long long)init[3]);
+  const __m512i w0 = _mm512_loadu_si512((const void *)m0);
+  const __m512i w1 = _mm512_loadu_si512((const void *)m1);
+
+  v3 = _mm512_xor_si512(v3, w0);
+  for (int r = 0; r < crounds; r++)
+    SIP512_ROUND(v0, v1, v2, v3);
+  v0 = _mm512_xor_si512(v0, w0);
+
+  v3 = _mm512_xor_si512(v3, w1);
+  for (int r = 0; r < crounds; r++)
+    SIP512_ROUND(v0, v1, v2, v3);
+  v0 = _mm512_xor_si512(v0, w1);
+
+  v2 = _mm512_xor_si512(v2, _mm512_set1_epi64(0xff));
+  for (int r = 0; r < drounds; r++)
+    SIP512_ROUND(v0, v1, v2, v3);
+
+  // v0 ^ v1 ^ v2 ^ v3 as one ternary-logic op plus one xor
+  __m512i h = _mm512_xor_si512(_mm512_ternarylogic_epi64(v0, v1, v2, 0x96), v3);
+  _mm512_storeu_si512((void *)out, h);
+}
+// AES-128 block for each ID, built with one shuffle: bytes 6..15, version
+// nibble and variant bits cleared, zero padding, length byte 10 in byte 15
+// (the same bytes as m0 || m1).
+#define AES_BLOCK_SHUF 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1
+#define AES_BLOCK_KEEP 0x0F, -1, 0x3F, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0
+#define AES_BLOCK_LEN 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10
+
+// Eight AES-NI pipelines interleaved: each aesenc has several cycles of
+// latency but issues every cycle, so independent blocks fill the gaps.
+__attribute__((target("aes,ssse3"))) static inline void aes128_mask_x8_aesni(const uint8_t rk[176], const uuid128_t *in,
+                                                                            uint64_t out[8])
+{
+  const __m128i shuf = _mm_setr_epi8(AES_BLOCK_SHUF);
+  const __m128i keep = _mm_setr_epi8(AES_BLOCK_KEEP);
+  const __m128i len = _mm_setr_epi8(AES_BLOCK_LEN);
+  __m128i b[8];
+  __m128i k = _mm_load_si128((const __m128i *)(const void *)&rk[0]);
+  for (int j = 0; j < 8; j++)
   {
-    if (i == dpos[0] || i == dpos[1] || i == dpos[2] || i == dpos[3])
-      out[j++] = '-';
-    out[j++] = hexd[(u->b[i] >> 4) & 0xF];
-    out[j++] = hexd[u->b[i] & 0xF];
+    __m128i u = _mm_loadu_si128((const __m128i *)(const void *)in[j].b);
+    b[j] = _mm_xor_si128(_mm_or_si128(_mm_and_si128(_mm_shuffle_epi8(u, shuf), keep), len), k);
   }
-  out[36] = '\0';
+  for (int r = 1; r < 10; r++)
+  {
+    k = _mm_load_si128((const __m128i *)(const void *)&rk[16 * r]);
+    for (int j = 0; j < 8; j++)
+      b[j] = _mm_aesenc_si128(b[j], k);
+  }
+  k = _mm_load_si128((const __m128i *)(const void *)&rk[16 * 10]);
+  for (int j = 0; j < 8; j++)
+    out[j] = (uint64_t)_mm_cvtsi128_si64(_mm_aesenclast_si128(b[j], k));
+}
+
+// Sixteen blocks with VAES: four blocks per zmm, four zmm in flight.
+__attribute__((target("vaes,avx512f,avx512bw"))) static inline void aes128_mask_x16_vaes(const uint8_t rk[176],
+                                                                                        const uuid128_t *in,
+                                                                                        uint64_t out[16])
+{
+  const __m512i shuf = _mm512_broadcast_i32x4(_mm_setr_epi8(AES_BLOCK_SHUF));
+  const __m512i keep = _mm512_broadcast_i32x4(_mm_setr_epi8(AES_BLOCK_KEEP));
+  const __m512i len = _mm512_broadcast_i32x4(_mm_setr_epi8(AES_BLOCK_LEN));
+  __m512i b[4];
+  __m512i k = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(const void *)&rk[0]));
+  for (int j = 0; j < 4; j++)
+  {
+    __m512i u = _mm512_loadu_si512((const void *)in[4 * j].b);
+    b[j] = _mm512_xor_si512(_mm512_or_si512(_mm512_and_si512(_mm512_shuffle_epi8(u, shuf), keep), len), k);
+  }
+  for (int r = 1; r < 10; r++)
+  {
+    k = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(const void *)&rk[16 * r]));
+    for (int j = 0; j < 4; j++)
+      b[j] = _mm512_aesenc_epi128(b[j], k);
+  }
+  k = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(const void *)&rk[16 * 10]));
+  for (int j = 0; j < 4; j++)
+  {
+    uint64_t blk[8];
+    _mm512_storeu_si512((void *)blk, _mm512_aesenclast_epi128(b[j], k));
+    for (int q = 0; q < 4; q++)
+      out[4 * j + q] = blk[2 * q];
+  }
+}
+#undef AES_BLOCK_SHUF
+#undef AES_BLOCK_KEEP
+#undef AES_BLOCK_LEN
+
+static inline bool uuidv47_cpu_has_vaes512(void)
+{
+  return __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+#endif // UUIDV47_X86_SIMD
+
+// Runtime kernel selection
+typedef enum uuidv47_simd_level
+{
+  UUIDV47_SIMD_SCALAR = 0,
+  UUIDV47_SIMD_AVX2 = 1,
+  UUIDV47_SIMD_AVX512 = 2, // AVX-512F + AVX-512VL
+} uuidv47_simd_level_t;
+
+// Best kernel the running CPU supports (cpuid via __builtin_cpu_supports, which
+// also accounts for OS-enabled register state). Cheap enough to call per batch.
+static inline uuidv47_simd_level_t uuidv47_simd_level(void)
+{
+#if UUIDV47_X86_SIMD
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl"))
+    return UUIDV47_SIMD_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return UUIDV47_SIMD_AVX2;
+#endif
+  return UUIDV47_SIMD_SCALAR;
+}
+
+// Transform `lanes` (8 for AVX-512, else 4) consecutive IDs with one kernel call.
+static inline void uuidv47_transform_lanes(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                           uuidv47_simd_level_t level, int ver)
+{
+  uint64_t m0[8], m1[8], h[8];
+  int lanes = level == UUIDV47_SIMD_AVX512 ? 8 : 4;
+  for (int j = 0; j < lanes; j++)
+    sip_words_from_uuid(&in[j], &m0[j], &m1[j]);
+#if UUIDV47_X86_SIMD
+  if (level == UUIDV47_SIMD_AVX512)
+    siphash_10_x8_avx512(ctx->v, ctx->crounds, ctx->drounds, m0, m1, h);
+  else if (level == UUIDV47_SIMD_AVX2)
+    siphash_10_x4_avx2(ctx->v, ctx->crounds, ctx->drounds, m0, m1, h);
+  else
+#endif
+    siphash_10_x4_portable(ctx->v, ctx->crounds, ctx->drounds, m0, m1, h);
+  for (int j = 0; j < lanes; j++)
+  {
+    out[j] = in[j];
+    uuidv47_apply_mask48(&out[j], h[j] & 0x0000FFFFFFFFFFFFULL, ver);
+  }
+}
+
+#if UUIDV47_X86_SIMD
+// UUIDV47_PRF_AES128: 16 blocks per VAES call at AVX-512 level when the CPU has
+// VAES, then 8-way AES-NI, then single blocks.
+static inline size_t uuidv47_transform_batch_aes(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                 size_t n, int ver, uuidv47_simd_level_t level)
+{
+  uint64_t h[16];
+  size_t i = 0;
+  if (level == UUIDV47_SIMD_AVX512 && uuidv47_cpu_has_vaes512())
+  {
+    for (; i + 16 <= n; i += 16)
+    {
+      aes128_mask_x16_vaes(ctx->aes_rk, &in[i], h);
+      for (size_t j = 0; j < 16; j++)
+      {
+        out[i + j] = in[i + j];
+        uuidv47_apply_mask48(&out[i + j], h[j] & 0x0000FFFFFFFFFFFFULL, ver);
+      }
+    }
+  }
+  for (; i + 8 <= n; i += 8)
+  {
+    aes128_mask_x8_aesni(ctx->aes_rk, &in[i], h);
+    for (size_t j = 0; j < 8; j++)
+    {
+      out[i + j] = in[i + j];
+      uuidv47_apply_mask48(&out[i + j], h[j] & 0x0000FFFFFFFFFFFFULL, ver);
+    }
+  }
+  return i;
+}
+#endif
+
+// `level` must be supported by the running CPU (uuidv47_simd_level()).
+static inline void uuidv47_transform_batch(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                           size_t n, int ver, uuidv47_simd_level_t level)
+{
+  size_t i = 0;
+#if UUIDV47_X86_SIMD
+  if (ctx->prf == UUIDV47_PRF_AES128)
+    i = uuidv47_transform_batch_aes(ctx, in, out, n, ver, level);
+  else
+#endif
+  {
+    if (level == UUIDV47_SIMD_AVX512)
+    {
+      for (; i + 8 <= n; i += 8)
+        uuidv47_transform_lanes(ctx, &in[i], &out[i], level, ver);
+      level = UUIDV47_SIMD_AVX2;
+    }
+    for (; i + 4 <= n; i += 4)
+      uuidv47_transform_lanes(ctx, &in[i], &out[i], level, ver);
+  }
+  for (; i < n; i++)
+  {
+    uint64_t mask48 = uuidv47_ctx_mask48(ctx, &in[i]);
+    out[i] = in[i];
+    uuidv47_apply_mask48(&out[i], mask48, ver);
+  }
+}
+
+// In-place transform: only the IDs of the expected version are touched, and
+// of those only bytes 0..5 (timestamp), the version nibble and the variant
+// bits are rewritten. IDs are taken 64 at a time; their message words feed
+// the lane kernels directly, without staging copies of the IDs.
+static inline void uuidv47_mask48_words_batch(const uuidv47_ctx_t *ctx, const uint64_t *m0, const uint64_t *m1,
+                                              uint64_t *h, size_t n, uuidv47_simd_level_t level)
+{
+  size_t i = 0;
+  if (ctx->prf != UUIDV47_PRF_AES128)
+  {
+#if UUIDV47_X86_SIMD
+    if (level == UUIDV47_SIMD_AVX512)
+      for (; i + 8 <= n; i += 8)
+        siphash_10_x8_avx512(ctx->v, ctx->crounds, ctx->drounds, &m0[i], &m1[i], &h[i]);
+    if (level >= UUIDV47_SIMD_AVX2)
+      for (; i + 4 <= n; i += 4)
+        siphash_10_x4_avx2(ctx->v, ctx->crounds, ctx->drounds, &m0[i], &m1[i], &h[i]);
+#endif
+    for (; i + 4 <= n; i += 4)
+      siphash_10_x4_portable(ctx->v, ctx->crounds, ctx->drounds, &m0[i], &m1[i], &h[i]);
+  }
+  for (; i < n; i++)
+    h[i] = uuidv47_ctx_mask48_words(ctx, m0[i], m1[i]);
+}
+
+// Strided form: ID i lives at (uint8_t *)base + offset + i * stride, e.g. a
+// uuid128_t field inside an array of row structs (uuid128_t is byte-aligned,
+// so any offset works). Records may not overlap in their ID bytes.
+static inline size_t uuidv47_transform_strided(const uuidv47_ctx_t *ctx, void *base, size_t n, size_t stride,
+                                               size_t offset, uint64_t *bad_mask, int from_ver, int to_ver)
+{
+  uint64_t m0[64], m1[64], h[64];
+  uuid128_t *ptr[64];
+  uint8_t *p = (uint8_t *)base + offset;
+  uuidv47_simd_level_t level = uuidv47_simd_level();
+  size_t done = 0;
+  for (size_t first = 0; first < n; first += 64)
+  {
+    size_t g = n - first < 64 ? n - first : 64, k = 0;
+    uint64_t bad = 0;
+    for (size_t j = 0; j < g; j++, p += stride)
+    {
+      uuid128_t *u = (uuid128_t *)(void *)p;
+      if (uuid_version(u) != from_ver)
+      {
+        bad |= 1ULL << j;
+        continue;
+      }
+      sip_words_from_uuid(u, &m0[k], &m1[k]);
+      ptr[k++] = u;
+    }
+    uuidv47_mask48_words_batch(ctx, m0, m1, h, k, level);
+    for (size_t t = 0; t < k; t++)
+      uuidv47_apply_mask48(ptr[t], h[t] & 0x0000FFFFFFFFFFFFULL, to_ver);
+    if (bad_mask)
+      bad_mask[first / 64] = bad;
+    done += k;
+  }
+  return done;
+}
+
+static inline size_t uuidv47_encode_strided(void *base, size_t n, size_t stride, size_t offset,
+                                            const uuidv47_ctx_t *ctx, uint64_t *bad_mask)
+{
+  return uuidv47_transform_strided(ctx, base, n, stride, offset, bad_mask, 7, 4);
+}
+
+static inline size_t uuidv47_decode_strided(void *base, size_t n, size_t stride, size_t offset,
+                                            const uuidv47_ctx_t *ctx, uint64_t *bad_mask)
+{
+  return uuidv47_transform_strided(ctx, base, n, stride, offset, bad_mask, 4, 7);
+}
+
+// ids[i] must be a v7 (resp. a v4 façade); others are left as they are and
+// flagged in bad_mask ((n + 63) / 64 words, may be NULL). Returns the number
+// of IDs transformed.
+static inline size_t uuidv47_encode_inplace(uuid128_t *ids, size_t n, const uuidv47_ctx_t *ctx, uint64_t *bad_mask)
+{
+  return uuidv47_encode_strided(ids, n, sizeof(uuid128_t), 0, ctx, bad_mask);
+}
+
+static inline size_t uuidv47_decode_inplace(uuid128_t *ids, size_t n, const uuidv47_ctx_t *ctx, uint64_t *bad_mask)
+{
+  return uuidv47_decode_strided(ids, n, sizeof(uuid128_t), 0, ctx, bad_mask);
+}
+
+// Creation time straight from a façade: the 48-bit ms timestamp a decode would
+// produce, without building the v7 (the version is not checked).
+static inline uint64_t uuidv47_facade_timestamp_ms(const uuid128_t *facade, const uuidv47_ctx_t *ctx)
+{
+  return rd48be(facade->b) ^ uuidv47_ctx_mask48(ctx, facade);
+}
+
+static inline void uuidv47_facade_timestamps_ms(const uuid128_t *facades, size_t n, const uuidv47_ctx_t *ctx,
+                                                uint64_t *ts_ms)
+{
+  uint64_t m0[64], m1[64];
+  uuidv47_simd_level_t level = uuidv47_simd_level();
+  for (size_t first = 0; first < n; first += 64)
+  {
+    size_t g = n - first < 64 ? n - first : 64;
+    for (size_t j = 0; j < g; j++)
+      sip_words_from_uuid(&facades[first + j], &m0[j], &m1[j]);
+    uuidv47_mask48_words_batch(ctx, m0, m1, &ts_ms[first], g, level);
+    for (size_t j = 0; j < g; j++)
+      ts_ms[first + j] = (ts_ms[first + j] ^ rd48be(facades[first + j].b)) & 0x0000FFFFFFFFFFFFULL;
+  }
+}
+
+// Time-range scans over v7 arrays: a selection bitmap or index list for
+// t0 <= ts < t1, and a histogram of fixed-width buckets from t0. The AVX2
+// kernel byte-swaps four 48-bit timestamps into 64-bit lanes with two
+// in-lane shuffles and compares them all at once (values stay below 2^48, so
+// the signed compare is exact).
+#if UUIDV47_X86_SIMD
+__attribute__((target("avx2"))) static inline __m256i uuidv47_ts48_x4_avx2(const uuid128_t *p)
+{
+  // IDs 0,1 -> 64-bit elements 0,2; IDs 2,3 -> elements 1,3; then reorder
+  const __m256i lo = _mm256_setr_epi8(5, 4, 3, 2, 1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                      5, 4, 3, 2, 1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i hi = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 5, 4, 3, 2, 1, 0, -1, -1,
+                                      -1, -1, -1, -1, -1, -1, -1, -1, 5, 4, 3, 2, 1, 0, -1, -1);
+  __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(const void *)&p[0]), lo);
+  __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(const void *)&p[2]), hi);
+  return _mm256_permute4x64_epi64(_mm256_or_si256(a, b), 0xD8);
+}
+
+__attribute__((target("avx2"))) static inline void uuidv47_ts48_x4_store(const uuid128_t *p, uint64_t out[4])
+{
+  _mm256_storeu_si256((__m256i *)(void *)out, uuidv47_ts48_x4_avx2(p));
+}
+
+// Bit j of the result is set when ID i + j is in range, for the first n & ~3 IDs.
+__attribute__((target("avx2,bmi"))) static inline size_t uuidv47_time_filter_avx2(const uuid128_t *ids, size_t n,
+                                                                                  uint64_t t0, uint64_t t1,
+                                                                                  uint64_t *bitmap, size_t *idx)
+{
+  const __m256i lo = _mm256_set1_epi64x((long long)t0), hi = _mm256_set1_epi64x((long long)t1);
+  size_t hits = 0;
+  for (size_t i = 0; i + 4 <= n; i += 4)
+  {
+    __m256i ts = uuidv47_ts48_x4_avx2(&ids[i]);
+    __m256i in = _mm256_andnot_si256(_mm256_cmpgt_epi64(lo, ts), _mm256_cmpgt_epi64(hi, ts));
+    unsigned m = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(in));
+    if (bitmap)
+      bitmap[i / 64] |= (uint64_t)m << (i % 64);
+    if (idx)
+      for (unsigned b = m; b; b &= b - 1)
+        idx[hits++] = i + _tzcnt_u32(b);
+    else
+      hits += (size_t)__builtin_popcount(m);
+  }
+  return hits;
+}
+#endif
+
+static inline size_t uuidv47_time_filter(const uuid128_t *ids, size_t n, uint64_t t0, uint64_t t1, uint64_t *bitmap,
+                                         size_t *idx)
+{
+  const uint64_t max48 = 0x0001000000000000ULL;
+  t0 = t0 < max48 ? t0 : max48;
+  t1 = t1 < max48 ? t1 : max48;
+  if (bitmap)
+    memset(bitmap, 0, (n + 63) / 64 * sizeof(uint64_t));
+  size_t i = 0, hits = 0;
+#if UUIDV47_X86_SIMD
+  if (uuidv47_simd_level() >= UUIDV47_SIMD_AVX2)
+  {
+    hits = uuidv47_time_filter_avx2(ids, n, t0, t1, bitmap, idx);
+    i = n & ~(size_t)3;
+  }
+#endif
+  for (; i < n; i++)
+  {
+    uint64_t ts = rd48be(ids[i].b);
+    if (ts >= t0 && ts < t1)
+    {
+      if (bitmap)
+        bitmap[i / 64] |= 1ULL << (i % 64);
+      if (idx)
+        idx[hits] = i;
+      hits++;
+    }
+  }
+  return hits;
+}
+
+// bitmap: (n + 63) / 64 words, bit i set when ids[i] is in [t0, t1). Returns the count.
+static inline size_t uuidv47_time_filter_bitmap(const uuid128_t *ids, size_t n, uint64_t t0, uint64_t t1,
+                                                uint64_t *bitmap)
+{
+  return uuidv47_time_filter(ids, n, t0, t1, bitmap, NULL);
+}
+
+// idx: room for n entries; receives the positions in [t0, t1) in order. Returns the count.
+static inline size_t uuidv47_time_filter_index(const uuid128_t *ids, size_t n, uint64_t t0, uint64_t t1, size_t *idx)
+{
+  return uuidv47_time_filter(ids, n, t0, t1, NULL, idx);
+}
+
+// counts[k] += number of IDs with t0 + k * bucket_ms <= ts < t0 + (k + 1) * bucket_ms,
+// for k < nbuckets (counts is not cleared, so calls accumulate). IDs outside
+// the covered span are skipped. Returns the number of IDs counted.
+static inline size_t uuidv47_time_histogram(const uuid128_t *ids, size_t n, uint64_t t0, uint64_t bucket_ms,
+                                            uint64_t *counts, size_t nbuckets)
+{
+  if (bucket_ms == 0 || nbuckets == 0)
+    return 0;
+  uint64_t ts[64];
+  size_t counted = 0;
+  bool pow2 = (bucket_ms & (bucket_ms - 1)) == 0;
+  unsigned shift = 0;
+  while (pow2 && (1ULL << shift) != bucket_ms)
+    shift++;
+  for (size_t first = 0; first < n; first += 64)
+  {
+    size_t g = n - first < 64 ? n - first : 64, j = 0;
+#if UUIDV47_X86_SIMD
+    if (uuidv47_simd_level() >= UUIDV47_SIMD_AVX2)
+      for (; j + 4 <= g; j += 4)
+        uuidv47_ts48_x4_store(&ids[first + j], &ts[j]);
+#endif
+    for (; j < g; j++)
+      ts[j] = rd48be(ids[first + j].b);
+    for (j = 0; j < g; j++)
+    {
+      uint64_t d = ts[j] - t0; // wraps for ts < t0, then fails the bound below
+      uint64_t k = pow2 ? d >> shift : d / bucket_ms;
+      if (ts[j] >= t0 && k < nbuckets)
+      {
+        counts[k]++;
+        counted++;
+      }
+    }
+  }
+  return counted;
+}
+
+// Sorting. IDs are ordered by their 16 bytes read as one big-endian number
+// (what memcmp gives, and the order of a B-tree on a uuid column). For v7 that
+// is timestamp first, so the sort is an LSD radix sort over bytes 5..0 with
+// one pass per byte, skipping passes in which every ID has the same digit
+// (the high timestamp bytes, for IDs from the same era). Runs of equal
+// timestamps are then finished on bytes 6..15: insertion sort for short runs,
+// the same radix sort for long ones. Any IDs sort correctly; v7 is the fast case.
+#ifndef UUIDV47_SORT_SMALL
+#define UUIDV47_SORT_SMALL 48
+#endif
+
+static inline int uuidv47_cmp(const uuid128_t *a, const uuid128_t *b)
+{
+  uint64_t x = rd64be(a->b), y = rd64be(b->b);
+  if (x == y)
+  {
+    x = rd64be(&a->b[8]);
+    y = rd64be(&b->b[8]);
+  }
+  return (x > y) - (x < y);
+}
+
+static inline void uuidv47_sort_insertion(uuid128_t *a, size_t n)
+{
+  for (size_t i = 1; i < n; i++)
+  {
+    uuid128_t x = a[i];
+    size_t j = i;
+    for (; j > 0 && uuidv47_cmp(&x, &a[j - 1]) < 0; j--)
+      a[j] = a[j - 1];
+    a[j] = x;
+  }
+}
+
+// Stable LSD radix sort of a[0..n) (n >= 1) on bytes first..last (span <= 10),
+// using tmp[0..n); the result is left in a. All histograms come from one read.
+static inline void uuidv47_sort_bytes(uuid128_t *a, uuid128_t *tmp, size_t n, unsigned first, unsigned last)
+{
+  size_t counts[10][256];
+  unsigned span = last - first + 1;
+  memset(counts, 0, span * sizeof counts[0]);
+  for (size_t i = 0; i < n; i++)
+    for (unsigned d = 0; d < span; d++)
+      counts[d][a[i].b[first + d]]++;
+  uuid128_t *src = a, *dst = tmp;
+  for (unsigned d = span; d-- > 0;)
+  {
+    size_t *c = counts[d];
+    if (c[src[0].b[first + d]] == n)
+      continue; // one digit value: the pass would not move anything
+    size_t sum = 0;
+    for (unsigned v = 0; v < 256; v++)
+    {
+      size_t k = c[v];
+      c[v] = sum;
+      sum += k;
+    }
+    for (size_t i = 0; i < n; i++)
+      dst[c[src[i].b[first + d]]++] = src[i];
+    uuid128_t *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != a)
+    memcpy(a, src, n * sizeof *a);
+}
+
+// Sorts ids[0..n) in place; scratch must have room for n IDs.
+static inline void uuidv47_sort(uuid128_t *ids, size_t n, uuid128_t *scratch)
+{
+  if (n <= UUIDV47_SORT_SMALL)
+  {
+    uuidv47_sort_insertion(ids, n);
+    return;
+  }
+  uuidv47_sort_bytes(ids, scratch, n, 0, 5);
+  for (size_t i = 0, j; i < n; i = j)
+  {
+    uint64_t ts = rd48be(ids[i].b);
+    for (j = i + 1; j < n && rd48be(ids[j].b) == ts; j++)
+      ;
+    if (j - i > UUIDV47_SORT_SMALL)
+      uuidv47_sort_bytes(&ids[i], &scratch[i], j - i, 6, 15);
+    else if (j - i > 1)
+      uuidv47_sort_insertion(&ids[i], j - i);
+  }
+}
+
+// Index variant: the records stay put and only (key, index) pairs move.
+typedef struct uuidv47_sort_ent
+{
+  uint64_t key;
+  size_t idx;
+} uuidv47_sort_ent_t;
+
+// Stable LSD radix sort of e[0..n) (n >= 1) on the low nbytes (<= 8) of key.
+static inline void uuidv47_sort_ent_bytes(uuidv47_sort_ent_t *e, uuidv47_sort_ent_t *tmp, size_t n, unsigned nbytes)
+{
+  size_t counts[8][256];
+  memset(counts, 0, nbytes * sizeof counts[0]);
+  for (size_t i = 0; i < n; i++)
+    for (unsigned d = 0; d < nbytes; d++)
+      counts[d][(e[i].key >> (8 * d)) & 0xFF]++;
+  uuidv47_sort_ent_t *src = e, *dst = tmp;
+  for (unsigned d = 0; d < nbytes; d++)
+  {
+    size_t *c = counts[d];
+    if (c[(src[0].key >> (8 * d)) & 0xFF] == n)
+      continue;
+    size_t sum = 0;
+    for (unsigned v = 0; v < 256; v++)
+    {
+      size_t k = c[v];
+      c[v] = sum;
+      sum += k;
+    }
+    for (size_t i = 0; i < n; i++)
+      dst[c[(src[i].key >> (8 * d)) & 0xFF]++] = src[i];
+    uuidv47_sort_ent_t *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != e)
+    memcpy(e, src, n * sizeof *e);
+}
+
+// perm[k] = index of the k-th smallest of ids[0..n); equal IDs keep their
+// input order. ids is only read. scratch must have room for 2 * n entries.
+static inline void uuidv47_sort_index(const uuid128_t *ids, size_t n, size_t *perm, uuidv47_sort_ent_t *scratch)
+{
+  uuidv47_sort_ent_t *e = scratch, *tmp = scratch + n;
+  if (n == 0)
+    return;
+  for (size_t i = 0; i < n; i++)
+  {
+    e[i].key = rd48be(ids[i].b);
+    e[i].idx = i;
+  }
+  uuidv47_sort_ent_bytes(e, tmp, n, 6);
+  for (size_t i = 0, j; i < n; i = j)
+  {
+    for (j = i + 1; j < n && e[j].key == e[i].key; j++)
+      ;
+    if (j - i > UUIDV47_SORT_SMALL)
+    {
+      // bytes 8..15, then (stably) bytes 6..7
+      for (size_t k = i; k < j; k++)
+        e[k].key = rd64be(&ids[e[k].idx].b[8]);
+      uuidv47_sort_ent_bytes(&e[i], &tmp[i], j - i, 8);
+      for (size_t k = i; k < j; k++)
+        e[k].key = (uint64_t)ids[e[k].idx].b[6] << 8 | ids[e[k].idx].b[7];
+      uuidv47_sort_ent_bytes(&e[i], &tmp[i], j - i, 2);
+    }
+    else
+      for (size_t k = i + 1; k < j; k++)
+      {
+        uuidv47_sort_ent_t x = e[k];
+        size_t m = k;
+        for (; m > i && uuidv47_cmp(&ids[x.idx], &ids[e[m - 1].idx]) < 0; m--)
+          e[m] = e[m - 1];
+        e[m] = x;
+      }
+  }
+  for (size_t i = 0; i < n; i++)
+    perm[i] = e[i].idx;
+}
+
+// Lookup in sorted arrays (uuidv47_sort order). Timestamps of v7 IDs in a
+// sorted set are close to uniform, so the position of a key is predictable
+// from its timestamp. uuidv47_interp_lower_bound needs no extra memory: one
+// interpolation probe, then a gallop outwards from it and a binary search of
+// the bracket it finds. uuidv47_lookup_t adds a radix table over the
+// timestamp range (slot k = first ID in the k-th equal-width time slice),
+// which narrows any key to a few IDs with one table read; slices that are
+// still crowded (bursts) fall through to the interpolation search.
+
+// First i in [lo, hi) with ids[i] >= key, or hi.
+static inline size_t uuidv47_binary_lower_bound(const uuid128_t *ids, size_t lo, size_t hi, const uuid128_t *key)
+{
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (uuidv47_cmp(&ids[mid], key) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static inline size_t uuidv47_interp_range(const uuid128_t *ids, size_t lo, size_t hi, const uuid128_t *key)
+{
+  if (hi - lo <= 16)
+    return uuidv47_binary_lower_bound(ids, lo, hi, key);
+  uint64_t t = rd48be(key->b), a = rd48be(ids[lo].b), b = rd48be(ids[hi - 1].b);
+  if (t <= a || b <= a)
+    return uuidv47_binary_lower_bound(ids, lo, hi, key);
+  if (t > b)
+    return hi;
+  size_t p = lo + (size_t)((double)(t - a) / (double)(b - a) * (double)(hi - 1 - lo));
+  if (uuidv47_cmp(&ids[p], key) < 0)
+  {
+    // answer > p: probe p+1, p+2, p+4, ... until one is not less
+    size_t l = p + 1, step = 1;
+    while (l + step - 1 < hi && uuidv47_cmp(&ids[l + step - 1], key) < 0)
+    {
+      l += step;
+      step *= 2;
+    }
+    return uuidv47_binary_lower_bound(ids, l, l + step - 1 < hi ? l + step - 1 : hi, key);
+  }
+  // answer <= p: probe p-1, p-2, p-4, ... until one is less
+  size_t h = p, step = 1;
+  while (h >= lo + step && uuidv47_cmp(&ids[h - step], key) >= 0)
+  {
+    h -= step;
+    step *= 2;
+  }
+  return uuidv47_binary_lower_bound(ids, h >= lo + step ? h - step + 1 : lo, h, key);
+}
+
+// First i with ids[i] >= key (n if none), over sorted ids[0..n).
+static inline size_t uuidv47_interp_lower_bound(const uuid128_t *ids, size_t n, const uuid128_t *key)
+{
+  return uuidv47_interp_range(ids, 0, n, key);
+}
+
+typedef struct uuidv47_lookup
+{
+  const uuid128_t *ids;
+  size_t n;
+  uint64_t ts_min;
+  unsigned shift;
+  size_t nslots;
+  const size_t *slot; // nslots + 1 entries
+} uuidv47_lookup_t;
+
+// A table size that leaves about 8 IDs per slot for uniform timestamps.
+static inline size_t uuidv47_lookup_slots(size_t n)
+{
+  size_t s = 1;
+  while (s < n / 8)
+    s *= 2;
+  return s;
+}
+
+// Builds the table over sorted ids[0..n) in one pass; slots has room for
+// nslots + 1 entries (nslots >= 1) and must outlive lk, as must ids.
+static inline void uuidv47_lookup_init(uuidv47_lookup_t *lk, const uuid128_t *ids, size_t n, size_t *slots,
+                                       size_t nslots)
+{
+  lk->ids = ids;
+  lk->n = n;
+  lk->nslots = nslots;
+  lk->slot = slots;
+  lk->ts_min = n ? rd48be(ids[0].b) : 0;
+  lk->shift = 0;
+  uint64_t span = n ? rd48be(ids[n - 1].b) - lk->ts_min : 0;
+  while ((span >> lk->shift) >= nslots)
+    lk->shift++;
+  size_t k = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    size_t b = (size_t)((rd48be(ids[i].b) - lk->ts_min) >> lk->shift);
+    while (k <= b)
+      slots[k++] = i;
+  }
+  while (k <= nslots)
+    slots[k++] = n;
+}
+
+// First i with ids[i] >= key, or n.
+static inline size_t uuidv47_lookup_lower_bound(const uuidv47_lookup_t *lk, const uuid128_t *key)
+{
+  uint64_t t = rd48be(key->b);
+  if (lk->n == 0 || t < lk->ts_min)
+    return 0;
+  uint64_t b = (t - lk->ts_min) >> lk->shift;
+  if (b >= lk->nslots)
+    return lk->n;
+  // earlier slices hold smaller timestamps, later ones larger
+  return uuidv47_interp_range(lk->ids, lk->slot[b], lk->slot[b + 1], key);
+}
+
+static inline bool uuidv47_lookup_find(const uuidv47_lookup_t *lk, const uuid128_t *key, size_t *pos)
+{
+  size_t i = uuidv47_lookup_lower_bound(lk, key);
+  if (i == lk->n || uuidv47_cmp(&lk->ids[i], key) != 0)
+    return false;
+  if (pos)
+    *pos = i;
+  return true;
+}
+
+// IDs with t0 <= timestamp < t1 are ids[*first .. *first + count); returns count.
+static inline size_t uuidv47_lookup_time_range(const uuidv47_lookup_t *lk, uint64_t t0, uint64_t t1, size_t *first)
+{
+  const uint64_t max48 = 0x0001000000000000ULL;
+  uuid128_t k0 = {{0}}, k1 = {{0}};
+  size_t lo = lk->n, hi = lk->n;
+  if (t0 < max48)
+  {
+    wr48be(k0.b, t0);
+    lo = uuidv47_lookup_lower_bound(lk, &k0);
+  }
+  if (t1 < max48)
+  {
+    wr48be(k1.b, t1);
+    hi = uuidv47_lookup_lower_bound(lk, &k1);
+  }
+  *first = lo;
+  return hi > lo ? hi - lo : 0;
+}
+
+// Block codec for v7 ID sequences. Up to UUIDV47_BLOCK_IDS IDs per block,
+// stored column by column:
+//
+//   byte 0      count - 1
+//   byte 1      delta width w (0..49); bit 7 set when deltas are zigzag coded
+//   bytes 2..7  first timestamp, big-endian
+//   deltas      count - 1 timestamp deltas, w bits each, LSB-first bit stream
+//   rand lo     count u64 little-endian: rand_b (62 bits) | (rand_a & 3) << 62
+//   rand hi     count 10-bit values rand_a >> 2, LSB-first bit stream
+//
+// Version and variant are implied, so only v7 IDs with the RFC variant can be
+// encoded. Deltas of a time-ordered block are stored as they are; any
+// decrease switches the block to zigzag coding, so arbitrary order still
+// round-trips. Blocks are self-delimiting and can be decoded one at a time.
+#define UUIDV47_BLOCK_IDS 128
+
+// Upper bound on the encoded size of n IDs.
+static inline size_t uuidv47_block_bound(size_t n)
+{
+  size_t blocks = (n + UUIDV47_BLOCK_IDS - 1) / UUIDV47_BLOCK_IDS;
+  return blocks * 8 + (n * 49 + 7) / 8 + n * 8 + (n * 10 + 7) / 8 + blocks * 2;
+}
+
+// Bytes of a block of count IDs with delta width `width`.
+static inline size_t uuidv47_block_size(size_t count, unsigned width)
+{
+  return 8 + ((count - 1) * width + 7) / 8 + count * 8 + (count * 10 + 7) / 8;
+}
+
+// Appends width-bit values to an LSB-first bit stream; returns the new end.
+static inline uint8_t *uuidv47_bits_pack(uint8_t *out, const uint64_t *v, size_t n, unsigned width)
+{
+  uint64_t acc = 0;
+  unsigned nbits = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    acc |= v[i] << nbits; // width + nbits <= 49 + 7
+    nbits += width;
+    for (; nbits >= 8; nbits -= 8, acc >>= 8)
+      *out++ = (uint8_t)acc;
+  }
+  if (nbits)
+    *out++ = (uint8_t)acc;
+  return out;
+}
+
+// Encodes ids[0..n), 1 <= n <= UUIDV47_BLOCK_IDS, as one block. Returns the
+// bytes written (uuidv47_block_bound(n) at most), or 0 if an ID is not v7.
+static inline size_t uuidv47_block_encode(const uuid128_t *ids, size_t n, uint8_t *out)
+{
+  uint64_t ts[UUIDV47_BLOCK_IDS], d[UUIDV47_BLOCK_IDS], lo[UUIDV47_BLOCK_IDS], hi[UUIDV47_BLOCK_IDS];
+  if (n == 0 || n > UUIDV47_BLOCK_IDS)
+    return 0;
+  bool monotonic = true;
+  for (size_t i = 0; i < n; i++)
+  {
+    uint64_t w0 = rd64be(ids[i].b), w1 = rd64be(&ids[i].b[8]);
+    if ((w0 & 0xF000) != 0x7000 || (w1 >> 62) != 2)
+      return 0;
+    ts[i] = w0 >> 16;
+    monotonic &= i == 0 || ts[i] >= ts[i - 1];
+    lo[i] = (w1 & 0x3FFFFFFFFFFFFFFFULL) | (w0 & 3) << 62;
+    hi[i] = (w0 & 0x0FFF) >> 2;
+  }
+  uint64_t all = 0;
+  for (size_t i = 1; i < n; i++)
+  {
+    int64_t sd = (int64_t)ts[i] - (int64_t)ts[i - 1];
+    d[i - 1] = monotonic ? (uint64_t)sd : ((uint64_t)sd << 1) ^ (uint64_t)(sd >> 63);
+    all |= d[i - 1];
+  }
+  unsigned width = 0;
+  while (width < 64 && (all >> width) != 0)
+    width++;
+
+  out[0] = (uint8_t)(n - 1);
+  out[1] = (uint8_t)(width | (monotonic ? 0u : 0x80u));
+  wr48be(&out[2], ts[0]);
+  uint8_t *p = uuidv47_bits_pack(&out[8], d, n - 1, width);
+  for (size_t i = 0; i < n; i++, p += 8)
+    wr64le(p, lo[i]);
+  p = uuidv47_bits_pack(p, hi, n, 10);
+  return (size_t)(p - out);
+}
+
+// Decodes one block from in[0..len) into out (room for UUIDV47_BLOCK_IDS).
+// Returns the bytes consumed and sets *n_out, or returns 0 when the block is
+// truncated or malformed.
+static inline size_t uuidv47_block_decode(const uint8_t *in, size_t len, uuid128_t *out, size_t *n_out)
+{
+  if (len < 8)
+    return 0;
+  size_t n = (size_t)in[0] + 1;
+  unsigned width = in[1] & 0x7Fu;
+  bool zigzag = (in[1] & 0x80u) != 0;
+  if (width > 49 || n > UUIDV47_BLOCK_IDS)
+    return 0;
+  size_t size = uuidv47_block_size(n, width);
+  if (len < size)
+    return 0;
+  // the delta stream is followed by at least 8 bytes of rand lo, so the
+  // 8-byte reads below stay inside the block
+  const uint8_t *deltas = &in[8], *lo = deltas + ((n - 1) * width + 7) / 8, *hi = lo + n * 8;
+  uint64_t mask = width ? ~0ULL >> (64 - width) : 0, ts[UUIDV47_BLOCK_IDS], bad;
+  // prefix sum first, then the independent per-ID assembly
+  ts[0] = bad = rd48be(&in[2]);
+  for (size_t i = 1, bit = 0; i < n; i++, bit += width)
+  {
+    uint64_t v = (rd64le(&deltas[bit / 8]) >> (bit % 8)) & mask;
+    ts[i] = ts[i - 1] + (zigzag ? (v >> 1) ^ (0 - (v & 1)) : v);
+    bad |= ts[i]; // a timestamp past 48 bits (or below zero) means a corrupt block
+  }
+  if (bad >> 48)
+    return 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    size_t hb = i * 10;
+    uint64_t r = rd64le(&lo[i * 8]);
+    uint64_t rand_a = ((uint64_t)(hi[hb / 8] | hi[hb / 8 + 1] << 8) >> (hb % 8) & 0x3FF) << 2 | r >> 62;
+    wr64be(out[i].b, ts[i] << 16 | 0x7000 | rand_a);
+    wr64be(&out[i].b[8], (r & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL);
+  }
+  *n_out = n;
+  return size;
+}
+
+// Whole sequences: ids[0..n) as consecutive full blocks (the last one
+// partial). Returns the bytes written, or 0 if an ID is not v7.
+static inline size_t uuidv47_blocks_encode(const uuid128_t *ids, size_t n, uint8_t *out)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < n; i += UUIDV47_BLOCK_IDS)
+  {
+    size_t k = uuidv47_block_encode(&ids[i], n - i < UUIDV47_BLOCK_IDS ? n - i : UUIDV47_BLOCK_IDS, &out[len]);
+    if (k == 0)
+      return 0;
+    len += k;
+  }
+  return len;
+}
+
+// Decodes whole blocks from in[0..len) while they fit in max_ids; *n_out
+// receives the IDs decoded. Returns the bytes consumed: less than len when
+// out is full, the input ends mid-block, or a block is malformed.
+static inline size_t uuidv47_blocks_decode(const uint8_t *in, size_t len, uuid128_t *out, size_t max_ids,
+                                           size_t *n_out)
+{
+  size_t used = 0, n = 0;
+  while (used < len && max_ids - n >= (size_t)in[used] + 1)
+  {
+    size_t k, got;
+    if ((k = uuidv47_block_decode(&in[used], len - used, &out[n], &got)) == 0)
+      break;
+    used += k;
+    n += got;
+  }
+  *n_out = n;
+  return used;
+}
+
+// Structure-of-arrays layout. Per ID: the 48-bit timestamp, and the 74 random
+// bits split exactly as the mask message reads them: rand_lo is message word
+// m0 (bytes 6..13 with the version nibble and variant bits cleared, little
+// endian) and rand_hi is bytes 14..15. Version and variant are not stored;
+// the caller knows which the columns hold and passes it when converting back.
+// Encode and decode only XOR ts48 with the mask, so they are one operation.
+typedef struct
+{
+  uint64_t *ts48;
+  uint64_t *rand_lo;
+  uint16_t *rand_hi;
+} uuidv47_soa_t;
+
+static inline void uuidv47_soa_from_uuids(const uuid128_t *in, size_t n, const uuidv47_soa_t *soa)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    uint64_t m0, m1;
+    sip_words_from_uuid(&in[i], &m0, &m1);
+    soa->ts48[i] = rd48be(in[i].b);
+    soa->rand_lo[i] = m0;
+    soa->rand_hi[i] = (uint16_t)m1;
+  }
+}
+
+static inline void uuidv47_soa_to_uuids(const uuidv47_soa_t *soa, size_t n, int ver, uuid128_t *out)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    uint64_t r = soa->rand_lo[i];
+    wr48be(out[i].b, soa->ts48[i]);
+    for (int k = 0; k < 8; k++)
+      out[i].b[6 + k] = (uint8_t)(r >> (8 * k));
+    out[i].b[14] = (uint8_t)soa->rand_hi[i];
+    out[i].b[15] = (uint8_t)(soa->rand_hi[i] >> 8);
+    set_version(&out[i], ver);
+    set_variant_rfc4122(&out[i]);
+  }
+}
+
+static inline void uuidv47_soa_xor_mask(const uuidv47_ctx_t *ctx, const uuidv47_soa_t *soa, size_t n)
+{
+  uint64_t m1[64], h[64];
+  uuidv47_simd_level_t level = uuidv47_simd_level();
+  for (size_t first = 0; first < n; first += 64)
+  {
+    size_t g = n - first < 64 ? n - first : 64;
+    for (size_t j = 0; j < g; j++)
+      m1[j] = (uint64_t)soa->rand_hi[first + j] | (10ULL << 56);
+    uuidv47_mask48_words_batch(ctx, &soa->rand_lo[first], m1, h, g, level);
+    for (size_t j = 0; j < g; j++)
+      soa->ts48[first + j] ^= h[j] & 0x0000FFFFFFFFFFFFULL;
+  }
+}
+
+static inline void uuidv47_soa_encode(const uuidv47_ctx_t *ctx, const uuidv47_soa_t *soa, size_t n)
+{
+  uuidv47_soa_xor_mask(ctx, soa, n);
+}
+
+static inline void uuidv47_soa_decode(const uuidv47_ctx_t *ctx, const uuidv47_soa_t *soa, size_t n)
+{
+  uuidv47_soa_xor_mask(ctx, soa, n);
+}
+
+static inline void uuidv47_ctx_encode_batch(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out, size_t n)
+{
+  uuidv47_transform_batch(ctx, in, out, n, 4, uuidv47_simd_level());
+}
+
+static inline void uuidv47_ctx_decode_batch(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out, size_t n)
+{
+  uuidv47_transform_batch(ctx, in, out, n, 7, uuidv47_simd_level());
+}
+
+static inline void uuidv47_encode_batch(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+  uuidv47_transform_batch(&ctx, in, out, n, 4, uuidv47_simd_level());
+}
+
+static inline void uuidv47_decode_batch(const uuid128_t *in, uuid128_t *out, size_t n, uuidv47_key_t key)
+{
+  uuidv47_ctx_t ctx;
+  uuidv47_ctx_init(&ctx, key);
+  uuidv47_transform_batch(&ctx, in, out, n, 7, uuidv47_simd_level());
+}
+
+// Experimental: bitsliced SipHash-2-4
+//
+// Processes 64 mask messages per call with each uint64_t holding one bit
+// position of a state word across all 64 lanes ("planes"). Rotations become
+// index offsets and xors are plane-wise, but every 64-bit add is a 64-step
+// ripple-carry chain, so this only pays off where wide SIMD is unavailable and
+// batches are large; bench.c compares it by batch size. Same results as the
+// other kernels.
+
+typedef struct
+{
+  uint64_t p[64]; // p[(bit + off) & 63] holds logical bit `bit` of every lane
+  unsigned off;
+} sip_bs_word_t;
+
+// In-place 64x64 bit-matrix transpose: bit j of a[i] <-> bit i of a[j].
+static inline void sip_bs_transpose64(uint64_t a[64])
+{
+  uint64_t m = 0x00000000FFFFFFFFULL;
+  for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j)
+  {
+    for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j)
+    {
+      uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+
+static inline void sip_bs_set_const(sip_bs_word_t *w, uint64_t c)
+{
+  w->off = 0;
+  for (unsigned b = 0; b < 64; b++)
+    w->p[b] = ((c >> b) & 1u) ? ~0ULL : 0ULL;
+}
+
+static inline void sip_bs_xor_const(sip_bs_word_t *w, uint64_t c)
+{
+  for (unsigned b = 0; b < 64; b++)
+    if ((c >> b) & 1u)
+      w->p[(b + w->off) & 63] = ~w->p[(b + w->off) & 63];
+}
+
+// w ^= planes (logical order, offset 0)
+static inline void sip_bs_xor_planes(sip_bs_word_t *w, const uint64_t planes[64])
+{
+  for (unsigned b = 0; b < 64; b++)
+    w->p[(b + w->off) & 63] ^= planes[b];
+}
+
+static inline void sip_bs_xor(sip_bs_word_t *a, const sip_bs_word_t *b)
+{
+  for (unsigned i = 0; i < 64; i++)
+    a->p[(i + a->off) & 63] ^= b->p[(i + b->off) & 63];
+}
+
+static inline void sip_bs_add(sip_bs_word_t *a, const sip_bs_word_t *b)
+{
+  uint64_t carry = 0;
+  for (unsigned i = 0; i < 64; i++)
+  {
+    uint64_t x = a->p[(i + a->off) & 63];
+    uint64_t y = b->p[(i + b->off) & 63];
+    uint64_t t = x ^ y;
+    a->p[(i + a->off) & 63] = t ^ carry;
+    carry = (x & y) | (carry & t);
+  }
+}
+
+// ROTL64 by r: logical bit i moves to i + r, i.e. its plane is found r lower.
+static inline void sip_bs_rotl(sip_bs_word_t *w, unsigned r)
+{
+  w->off = (w->off - r) & 63;
+}
+
+static inline void sip_bs_round(sip_bs_word_t *v)
+{
+  sip_bs_add(&v[0], &v[1]);
+  sip_bs_add(&v[2], &v[3]);
+  sip_bs_rotl(&v[1], 13);
+  sip_bs_rotl(&v[3], 16);
+  sip_bs_xor(&v[1], &v[0]);
+  sip_bs_xor(&v[3], &v[2]);
+  sip_bs_rotl(&v[0], 32);
+  sip_bs_add(&v[2], &v[1]);
+  sip_bs_add(&v[0], &v[3]);
+  sip_bs_rotl(&v[1], 17);
+  sip_bs_rotl(&v[3], 21);
+  sip_bs_xor(&v[1], &v[2]);
+  sip_bs_xor(&v[3], &v[0]);
+  sip_bs_rotl(&v[2], 32);
+}
+
+// SipHash-c-d of 64 10-byte messages (as in siphash24_10_state for 2-4).
+static inline void siphash_10_x64_bitsliced(const uint64_t init[4], int crounds, int drounds,
+                                            const uint64_t m0[64], const uint64_t m1[64], uint64_t out[64])
+{
+  sip_bs_word_t v[4];
+  uint64_t w0[64], w1[64];
+  memcpy(w0, m0, sizeof(w0));
+  memcpy(w1, m1, sizeof(w1));
+  sip_bs_transpose64(w0);
+  sip_bs_transpose64(w1);
+  for (int k = 0; k < 4; k++)
+    sip_bs_set_const(&v[k], init[k]);
+
+  sip_bs_xor_planes(&v[3], w0);
+  for (int r = 0; r < crounds; r++)
+    sip_bs_round(v);
+  sip_bs_xor_planes(&v[0], w0);
+
+  sip_bs_xor_planes(&v[3], w1);
+  for (int r = 0; r < crounds; r++)
+    sip_bs_round(v);
+  sip_bs_xor_planes(&v[0], w1);
+
+  sip_bs_xor_const(&v[2], 0xff);
+  for (int r = 0; r < drounds; r++)
+    sip_bs_round(v);
+
+  sip_bs_xor(&v[0], &v[1]);
+  sip_bs_xor(&v[0], &v[2]);
+  sip_bs_xor(&v[0], &v[3]);
+  for (unsigned b = 0; b < 64; b++)
+    out[b] = v[0].p[(b + v[0].off) & 63];
+  sip_bs_transpose64(out);
+}
+
+static inline void uuidv47_transform_batch_bitsliced(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                     size_t n, int ver)
+{
+  uint64_t m0[64], m1[64], h[64];
+  size_t i = 0;
+  // only SipHash PRFs are bitsliced; others go straight to the regular path
+  size_t bulk = ctx->prf == UUIDV47_PRF_AES128 ? 0 : n;
+  for (; i + 64 <= bulk; i += 64)
+  {
+    for (size_t j = 0; j < 64; j++)
+      sip_words_from_uuid(&in[i + j], &m0[j], &m1[j]);
+    siphash_10_x64_bitsliced(ctx->v, ctx->crounds, ctx->drounds, m0, m1, h);
+    for (size_t j = 0; j < 64; j++)
+    {
+      out[i + j] = in[i + j];
+      uuidv47_apply_mask48(&out[i + j], h[j] & 0x0000FFFFFFFFFFFFULL, ver);
+    }
+  }
+  uuidv47_transform_batch(ctx, &in[i], &out[i], n - i, ver, uuidv47_simd_level());
+}
+
+static inline void uuidv47_ctx_encode_batch_bitsliced(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                      size_t n)
+{
+  uuidv47_transform_batch_bitsliced(ctx, in, out, n, 4);
+}
+
+static inline void uuidv47_ctx_decode_batch_bitsliced(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                      size_t n)
+{
+  uuidv47_transform_batch_bitsliced(ctx, in, out, n, 7);
+}
+
+// String I/O (canonical 8-4-4-4-12)
+static inline int hexval(int c)
+{
+  if ('0' <= c && c <= '9')
+    return c - '0';
+  if ('a' <= c && c <= 'f')
+    return c - 'a' + 10;
+  if ('A' <= c && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static inline bool uuid_parse_scalar(const char *s, uuid128_t *out)
+{
+  // expects xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+  int idxs[32] = {0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, 16, 17, 19, 20, 21, 22, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35};
+  uint8_t b[16] = {0};
+  if (s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-')
+    return false;
+  for (int i = 0; i < 16; i++)
+  {
+    int h = hexval(s[idxs[i * 2]]);
+    int l = hexval(s[idxs[i * 2 + 1]]);
+    if (h < 0 || l < 0)
+      return false;
+    b[i] = (uint8_t)((h << 4) | l);
+  }
+  memcpy(out->b, b, 16);
+  return true;
+}
+
+#if UUIDV47_X86_SIMD
+// 16 ASCII hex digits -> nibble values; *ok gets 0xFF for each valid digit.
+__attribute__((target("sse4.1"))) static inline __m128i hex16_nibbles_sse41(__m128i x, __m128i *ok)
+{
+  const __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+  const __m128i l = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  const __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  const __m128i is_l = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+  *ok = _mm_or_si128(is_d, is_l);
+  return _mm_blendv_epi8(_mm_add_epi8(l, _mm_set1_epi8(10)), d, is_d);
+}
+
+// 32 hex nibbles (two vectors) -> 16 bytes, high nibble first.
+__attribute__((target("sse4.1"))) static inline __m128i hex_pack_sse41(__m128i lo, __m128i hi)
+{
+  const __m128i w = _mm_set1_epi16(0x0110); // even byte * 16 + odd byte * 1
+  return _mm_packus_epi16(_mm_maddubs_epi16(lo, w), _mm_maddubs_epi16(hi, w));
+}
+
+// Canonical form with three overlapping loads covering exactly s[0..35]: the
+// 32 digits are gathered by shuffles, hyphens and hex validity are folded
+// into a single compare mask, and the nibbles are packed with pmaddubsw.
+__attribute__((target("sse4.1"))) static inline bool uuid_parse_sse41(const char *s, uuid128_t *out)
+{
+  const __m128i a = _mm_loadu_si128((const __m128i *)(const void *)s);        // s[0..15]
+  const __m128i b = _mm_loadu_si128((const __m128i *)(const void *)(s + 16)); // s[16..31]
+  const __m128i c = _mm_loadu_si128((const __m128i *)(const void *)(s + 20)); // s[20..35]
+
+  const __m128i lo = _mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, -1, -1)),
+                                  _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1)));
+  const __m128i hi = _mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1)),
+                                  _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 12, 13, 14, 15)));
+  // s[8], s[13], s[18], s[23] in bytes 0..3, zeros elsewhere
+  const __m128i dashes = _mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(8, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                      _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+  const __m128i dash_ok = _mm_cmpeq_epi8(dashes, _mm_setr_epi8('-', '-', '-', '-', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+
+  __m128i ok_lo, ok_hi;
+  const __m128i n_lo = hex16_nibbles_sse41(lo, &ok_lo);
+  const __m128i n_hi = hex16_nibbles_sse41(hi, &ok_hi);
+  const __m128i ok = _mm_and_si128(_mm_and_si128(ok_lo, ok_hi), dash_ok);
+  if (_mm_movemask_epi8(ok) != 0xFFFF)
+    return false;
+  _mm_storeu_si128((__m128i *)(void *)out->b, hex_pack_sse41(n_lo, n_hi));
+  return true;
+}
+
+static inline bool uuidv47_cpu_has_sse41(void)
+{
+  return __builtin_cpu_supports("sse4.1") != 0;
+}
+#endif // UUIDV47_X86_SIMD
+
+// Reads exactly s[0..35]; rejects non-hex digits and misplaced hyphens.
+// Upper- and lowercase hex are both accepted.
+static inline bool uuid_parse(const char *s, uuid128_t *out)
+{
+#if UUIDV47_X86_SIMD
+  if (uuidv47_cpu_has_sse41())
+    return uuid_parse_sse41(s, out);
+#endif
+  return uuid_parse_scalar(s, out);
+}
+
+// Length-aware parsing of the forms clients actually send:
+//   32  xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+//   36  xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+//   38  {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}
+//   45  urn:uuid:xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx   (prefix case-insensitive)
+// Hex digits may be any mix of cases. Never reads past s[len - 1]; the
+// shape is picked from len, then the 32/36 cores take the SIMD paths.
+typedef enum
+{
+  UUID_PARSE_OK = 0,
+  UUID_PARSE_ERR_LENGTH = 1, // len matches none of the forms
+  UUID_PARSE_ERR_SYNTAX = 2, // hyphen, brace or urn prefix missing or misplaced
+  UUID_PARSE_ERR_HEX = 3,    // a digit position holds a non-hex character
+} uuid_parse_status_t;
+
+static inline bool uuid_parse_hex32_scalar(const char *s, uuid128_t *out)
+{
+  uint8_t b[16];
+  for (int i = 0; i < 16; i++)
+  {
+    int h = hexval(s[2 * i]);
+    int l = hexval(s[2 * i + 1]);
+    if (h < 0 || l < 0)
+      return false;
+    b[i] = (uint8_t)((h << 4) | l);
+  }
+  memcpy(out->b, b, 16);
+  return true;
+}
+
+#if UUIDV47_X86_SIMD
+__attribute__((target("sse4.1"))) static inline bool uuid_parse_hex32_sse41(const char *s, uuid128_t *out)
+{
+  __m128i ok_lo, ok_hi;
+  const __m128i n_lo = hex16_nibbles_sse41(_mm_loadu_si128((const __m128i *)(const void *)s), &ok_lo);
+  const __m128i n_hi = hex16_nibbles_sse41(_mm_loadu_si128((const __m128i *)(const void *)(s + 16)), &ok_hi);
+  if (_mm_movemask_epi8(_mm_and_si128(ok_lo, ok_hi)) != 0xFFFF)
+    return false;
+  _mm_storeu_si128((__m128i *)(void *)out->b, hex_pack_sse41(n_lo, n_hi));
+  return true;
+}
+#endif // UUIDV47_X86_SIMD
+
+// Slow path for a rejected canonical core: tell a misplaced hyphen from a bad digit.
+static inline uuid_parse_status_t uuid_parse_classify36(const char *s)
+{
+  for (int i = 0; i < 36; i++)
+  {
+    bool dash = (i == 8 || i == 13 || i == 18 || i == 23);
+    if (dash ? s[i] != '-' : s[i] == '-')
+      return UUID_PARSE_ERR_SYNTAX;
+  }
+  return UUID_PARSE_ERR_HEX;
+}
+
+static inline uuid_parse_status_t uuid_parse_any(const char *s, size_t len, uuid128_t *out)
+{
+  switch (len)
+  {
+  case 32:
+#if UUIDV47_X86_SIMD
+    if (uuidv47_cpu_has_sse41())
+      return uuid_parse_hex32_sse41(s, out) ? UUID_PARSE_OK : UUID_PARSE_ERR_HEX;
+#endif
+    return uuid_parse_hex32_scalar(s, out) ? UUID_PARSE_OK : UUID_PARSE_ERR_HEX;
+  case 36:
+    break;
+  case 38:
+    if (s[0] != '{' || s[37] != '}')
+      return UUID_PARSE_ERR_SYNTAX;
+    s += 1;
+    break;
+  case 45:
+  {
+    static const char urn[9] = {'u', 'r', 'n', ':', 'u', 'u', 'i', 'd', ':'};
+    for (int i = 0; i < 9; i++)
+    {
+      char c = (i == 3 || i == 8) ? s[i] : (char)(s[i] | 0x20); // ASCII fold of the letter positions
+      if (c != urn[i])
+        return UUID_PARSE_ERR_SYNTAX;
+    }
+    s += 9;
+    break;
+  }
+  default:
+    return UUID_PARSE_ERR_LENGTH;
+  }
+  return uuid_parse(s, out) ? UUID_PARSE_OK : uuid_parse_classify36(s);
+}
+
+// Formatting: uuid_format36 writes the 36 characters without a terminator
+// (lowercase, or uppercase when `upper`); uuid_format adds the NUL.
+static inline void uuid_format36_scalar(const uuid128_t *u, char out[36], bool upper)
+{
+  static const uint8_t pos[16] = {0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34};
+  const char *hexd = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  for (int i = 0; i < 16; i++)
+  {
+    out[pos[i]] = hexd[u->b[i] >> 4];
+    out[pos[i] + 1] = hexd[u->b[i] & 0xF];
+  }
+  out[8] = out[13] = out[18] = out[23] = '-';
+}
+
+#if UUIDV47_X86_SIMD
+// Nibbles -> hex via one pshufb lookup; a fixed permutation spreads the 32
+// digits over the 8-4-4-4-12 layout and an OR drops the hyphens in.
+__attribute__((target("ssse3"))) static inline void uuid_format36_ssse3(const uuid128_t *u, char out[36], bool upper)
+{
+  const __m128i lut = upper ? _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F')
+                            : _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i v = _mm_loadu_si128((const __m128i *)(const void *)u->b);
+  const __m128i lo = _mm_and_si128(v, _mm_set1_epi8(0x0F));
+  const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+  const __m128i c0 = _mm_shuffle_epi8(lut, _mm_unpacklo_epi8(hi, lo)); // digits 0..15
+  const __m128i c1 = _mm_shuffle_epi8(lut, _mm_unpackhi_epi8(hi, lo)); // digits 16..31
+
+  const __m128i o0 = _mm_or_si128(_mm_shuffle_epi8(c0, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12, 13)),
+                                  _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0));
+  const __m128i o1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, _mm_setr_epi8(14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                               _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, 0, 1, 2, 3, -1, 4, 5, 6, 7, 8, 9, 10, 11))),
+                                  _mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0));
+  const int tail = _mm_cvtsi128_si32(_mm_srli_si128(c1, 12)); // digits 28..31
+  _mm_storeu_si128((__m128i *)(void *)out, o0);
+  _mm_storeu_si128((__m128i *)(void *)(out + 16), o1);
+  memcpy(out + 32, &tail, 4);
+}
+
+static inline bool uuidv47_cpu_has_ssse3(void)
+{
+  return __builtin_cpu_supports("ssse3") != 0;
+}
+#endif // UUIDV47_X86_SIMD
+
+static inline void uuid_format36(const uuid128_t *u, char out[36], bool upper)
+{
+#if UUIDV47_X86_SIMD
+  if (uuidv47_cpu_has_ssse3())
+  {
+    uuid_format36_ssse3(u, out, upper);
+    return;
+  }
+#endif
+  uuid_format36_scalar(u, out, upper);
+}
+
+static inline void uuid_format(const uuid128_t *u, char out[37])
+{
+  uuid_format36(u, out, false);
+  out[36] = '\0';
+}
+
+// Compact encodings
+//
+// Crockford base32: 26 characters, the first carrying the top 3 bits (so it is
+// always 0-7, as in ULID). Output is uppercase; parsing is case-insensitive and
+// accepts the Crockford aliases I/L -> 1 and O -> 0.
+//
+// base64url: 22 characters (RFC 4648 section 5, no padding). The last
+// character carries 2 bits; parsing rejects it unless the 4 spare bits are
+// zero, so every ID has exactly one accepted spelling.
+static inline void uuid_format_base32(const uuid128_t *u, char out[26])
+{
+  static const char alpha[32] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+                                 'G', 'H', 'J', 'K', 'M', 'N', 'P', 'Q', 'R', 'S', 'T', 'V', 'W', 'X', 'Y', 'Z'};
+  uint64_t hi = rd64be(&u->b[0]), lo = rd64be(&u->b[8]);
+  out[0] = alpha[hi >> 61];
+  for (int k = 0; k < 12; k++)
+    out[1 + k] = alpha[(hi >> (56 - 5 * k)) & 31];
+  out[13] = alpha[((hi & 1) << 4) | (lo >> 60)];
+  for (int k = 0; k < 12; k++)
+    out[14 + k] = alpha[(lo >> (55 - 5 * k)) & 31];
+}
+
+static inline bool uuid_parse_base32(const char s[26], uuid128_t *out)
+{
+  // value + 1 per byte, 0 = invalid: 0-9 A-Z a-z minus I L O U, plus O/o -> 0 and I/i/L/l -> 1
+  static const uint8_t dec[256] = {
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       1,  2,  3,  4,  5,  6,  7,  8,  9, 10,  0,  0,  0,  0,  0,  0,
+       0, 11, 12, 13, 14, 15, 16, 17, 18,  2, 19, 20,  2, 21, 22,  1,
+      23, 24, 25, 26, 27,  0, 28, 29, 30, 31, 32,  0,  0,  0,  0,  0,
+       0, 11, 12, 13, 14, 15, 16, 17, 18,  2, 19, 20,  2, 21, 22,  1,
+      23, 24, 25, 26, 27,  0, 28, 29, 30, 31, 32,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+  };
+  uint8_t d[26];
+  uint8_t bad = 0;
+  for (int k = 0; k < 26; k++)
+  {
+    d[k] = (uint8_t)(dec[(unsigned char)s[k]] - 1);
+    bad |= d[k] & 0xE0; // 0 - 1 wraps to 0xFF
+  }
+  if (bad || d[0] > 7)
+    return false;
+  uint64_t hi = (uint64_t)d[0] << 61, lo = 0;
+  for (int k = 0; k < 12; k++)
+    hi |= (uint64_t)d[1 + k] << (56 - 5 * k);
+  hi |= (uint64_t)(d[13] >> 4);
+  lo = (uint64_t)(d[13] & 15) << 60;
+  for (int k = 0; k < 12; k++)
+    lo |= (uint64_t)d[14 + k] << (55 - 5 * k);
+  wr64be(&out->b[0], hi);
+  wr64be(&out->b[8], lo);
+  return true;
+}
+
+static inline void uuid_format_base64url_scalar(const uuid128_t *u, char out[22])
+{
+  static const char alpha[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+  const uint8_t *b = u->b;
+  for (int i = 0, k = 0; i < 15; i += 3, k += 4)
+  {
+    uint32_t t = ((uint32_t)b[i] << 16) | ((uint32_t)b[i + 1] << 8) | b[i + 2];
+    out[k] = alpha[t >> 18];
+    out[k + 1] = alpha[(t >> 12) & 63];
+    out[k + 2] = alpha[(t >> 6) & 63];
+    out[k + 3] = alpha[t & 63];
+  }
+  out[20] = alpha[b[15] >> 2];
+  out[21] = alpha[(b[15] & 3) << 4];
+}
+
+static inline int b64url_value(unsigned char c)
+{
+  static const int8_t dec[128] = {
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+      52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+      -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+      15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+      -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+      41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+  };
+  return c < 128 ? dec[c] : -1;
+}
+
+// Characters 16..21 -> bytes 12..15; shared by the scalar and SSSE3 parsers.
+static inline bool b64url_parse_tail(const char s[22], uint8_t b[16])
+{
+  int v[6];
+  int bad = 0;
+  for (int k = 0; k < 6; k++)
+    bad |= v[k] = b64url_value((unsigned char)s[16 + k]);
+  if (bad < 0 || (v[5] & 15))
+    return false;
+  b[12] = (uint8_t)((v[0] << 2) | (v[1] >> 4));
+  b[13] = (uint8_t)((v[1] << 4) | (v[2] >> 2));
+  b[14] = (uint8_t)((v[2] << 6) | v[3]);
+  b[15] = (uint8_t)((v[4] << 2) | (v[5] >> 4));
+  return true;
+}
+
+static inline bool uuid_parse_base64url_scalar(const char s[22], uuid128_t *out)
+{
+  uint8_t b[16];
+  for (int i = 0, k = 0; i < 12; i += 3, k += 4)
+  {
+    int a = b64url_value((unsigned char)s[k]), c = b64url_value((unsigned char)s[k + 1]);
+    int d = b64url_value((unsigned char)s[k + 2]), e = b64url_value((unsigned char)s[k + 3]);
+    if ((a | c | d | e) < 0)
+      return false;
+    uint32_t t = ((uint32_t)a << 18) | ((uint32_t)c << 12) | ((uint32_t)d << 6) | (uint32_t)e;
+    b[i] = (uint8_t)(t >> 16);
+    b[i + 1] = (uint8_t)(t >> 8);
+    b[i + 2] = (uint8_t)t;
+  }
+  if (!b64url_parse_tail(s, b))
+    return false;
+  memcpy(out->b, b, 16);
+  return true;
+}
+
+#if UUIDV47_X86_SIMD
+// Bytes 0..11 <-> characters 0..15 in one register (the usual pshufb/multiply
+// base64 kernels); the 4-byte / 6-character tail is done in scalar code.
+__attribute__((target("ssse3"))) static inline void uuid_format_base64url_ssse3(const uuid128_t *u, char out[22])
+{
+  __m128i in = _mm_loadu_si128((const __m128i *)u->b);
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  // 6-bit fields of each 3-byte group into the 4 bytes of a 32-bit lane
+  __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+  __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+  __m128i idx = _mm_or_si128(t0, t1);
+  // 0..25 -> row 13 ('A'), 26..51 -> row 0, 52..61 -> rows 1..10, 62 -> 11, 63 -> 12
+  __m128i row = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+  row = _mm_or_si128(row, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+  const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                      '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0);
+  _mm_storeu_si128((__m128i *)out, _mm_add_epi8(idx, _mm_shuffle_epi8(shift, row)));
+
+  const uint8_t *b = u->b;
+  static const char alpha[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+  out[16] = alpha[b[12] >> 2];
+  out[17] = alpha[((b[12] & 3) << 4) | (b[13] >> 4)];
+  out[18] = alpha[((b[13] & 15) << 2) | (b[14] >> 6)];
+  out[19] = alpha[b[14] & 63];
+  out[20] = alpha[b[15] >> 2];
+  out[21] = alpha[(b[15] & 3) << 4];
+}
+
+__attribute__((target("ssse3"))) static inline bool uuid_parse_base64url_ssse3(const char s[22], uuid128_t *out)
+{
+  const __m128i v = _mm_loadu_si128((const __m128i *)s);
+  // per-class offsets, picked by range masks; any byte in no class fails
+  __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+  __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+  __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  __m128i dash = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+  __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  __m128i any = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(dash, under)));
+  if (_mm_movemask_epi8(any) != 0xFFFF)
+    return false;
+  __m128i off = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  off = _mm_or_si128(off, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  off = _mm_or_si128(off, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  off = _mm_or_si128(off, _mm_and_si128(dash, _mm_set1_epi8(62 - '-')));
+  off = _mm_or_si128(off, _mm_and_si128(under, _mm_set1_epi8(63 - '_')));
+  __m128i idx = _mm_add_epi8(v, off);
+  // 4 x 6 bits -> 24 bits per lane, then drop the top byte of each lane
+  __m128i w = _mm_madd_epi16(_mm_maddubs_epi16(idx, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+  w = _mm_shuffle_epi8(w, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  uint8_t b[16];
+  _mm_storeu_si128((__m128i *)b, w);
+  if (!b64url_parse_tail(s, b))
+    return false;
+  memcpy(out->b, b, 16);
+  return true;
+}
+#endif // UUIDV47_X86_SIMD
+
+static inline void uuid_format_base64url(const uuid128_t *u, char out[22])
+{
+#if UUIDV47_X86_SIMD
+  if (uuidv47_cpu_has_ssse3())
+  {
+    uuid_format_base64url_ssse3(u, out);
+    return;
+  }
+#endif
+  uuid_format_base64url_scalar(u, out);
+}
+
+static inline bool uuid_parse_base64url(const char s[22], uuid128_t *out)
+{
+#if UUIDV47_X86_SIMD
+  if (uuidv47_cpu_has_ssse3())
+    return uuid_parse_base64url_ssse3(s, out);
+#endif
+  return uuid_parse_base64url_scalar(s, out);
+}
+
+// Façade straight to / from base64url: v7 in, 22 characters out, and back.
+// Convenience wrappers over the ctx transform and the base64url codec (no
+// fused kernel: the mask needs the full random tail either way). Decoding
+// rejects anything that is not a version-4 façade.
+static inline void uuidv47_ctx_encode_base64url(const uuidv47_ctx_t *ctx, const uuid128_t *v7, char out[22])
+{
+  uuid128_t f = uuidv47_ctx_encode(ctx, v7);
+  uuid_format_base64url(&f, out);
+}
+
+static inline bool uuidv47_ctx_decode_base64url(const uuidv47_ctx_t *ctx, const char s[22], uuid128_t *v7)
+{
+  uuid128_t f;
+  if (!uuid_parse_base64url(s, &f) || uuid_version(&f) != 4)
+    return false;
+  *v7 = uuidv47_ctx_decode(ctx, &f);
+  return true;
+}
+
+// Fused string transforms
+//
+// v7 string <-> façade string without re-hexing what does not change: the
+// input is parsed once for the mask, then only the 12 timestamp digits and
+// the version/variant digits are rewritten; every other character is copied
+// as-is (out may equal in). Rewritten digits follow the input's case. Returns
+// false, leaving out untouched, unless the input is a canonical UUID of the
+// expected version.
+static inline uint64_t hex8_swar(uint32_t v, bool upper)
+{
+  // spread the 8 nibbles of v into 8 bytes (nibble i -> byte i), then map to ASCII
+  uint64_t x = v;
+  x = ((x & 0xFFFF0000ULL) << 16) | (x & 0x0000FFFFULL);
+  x = ((x & 0x0000FF000000FF00ULL) << 8) | (x & 0x000000FF000000FFULL);
+  x = ((x & 0x00F000F000F000F0ULL) << 4) | (x & 0x000F000F000F000FULL);
+  uint64_t letters = ((x + 0x0606060606060606ULL) >> 4) & 0x0101010101010101ULL;
+  return x + 0x3030303030303030ULL + letters * (upper ? 7u : 39u);
+}
+
+static inline bool uuidv47_str_transform(const uuidv47_ctx_t *ctx, const char in[36], char out[36], int from_ver,
+                                         int to_ver)
+{
+  uuid128_t u;
+  if (!uuid_parse(in, &u) || uuid_version(&u) != from_ver)
+    return false;
+  // input is known hex/hyphen here, so an uppercase letter is a byte with 0x40 set and 0x20 clear
+  uint64_t w[5], acc = 0;
+  memcpy(w, in, 32);
+  memcpy(&w[4], in + 28, 8);
+  for (int i = 0; i < 5; i++)
+    acc |= w[i] & ~(w[i] << 1);
+  bool upper = (acc & 0x4040404040404040ULL) != 0;
+
+  uint64_t ts = rd48be(u.b) ^ uuidv47_ctx_mask48(ctx, &u);
+  uint64_t hi = hex8_swar((uint32_t)(ts >> 16), upper);
+  uint64_t lo = hex8_swar((uint32_t)(ts & 0xFFFF), upper);
+  int var = 0x8 | ((u.b[8] >> 4) & 0x3);
+
+  if (out != in)
+    memcpy(out, in, 36);
+  char digits[12];
+  for (int k = 0; k < 8; k++)
+    digits[k] = (char)(hi >> (8 * (7 - k)));
+  for (int k = 0; k < 4; k++)
+    digits[8 + k] = (char)(lo >> (8 * (3 - k)));
+  memcpy(out, digits, 8);
+  memcpy(out + 9, digits + 8, 4);
+  out[14] = (char)('0' + to_ver);
+  out[19] = (char)(var < 10 ? '0' + var : (upper ? 'A' : 'a') + var - 10);
+  return true;
+}
+
+static inline bool uuidv47_v7_str_to_facade_str(const uuidv47_ctx_t *ctx, const char in[36], char out[36])
+{
+  return uuidv47_str_transform(ctx, in, out, 7, 4);
+}
+
+static inline bool uuidv47_facade_str_to_v7_str(const uuidv47_ctx_t *ctx, const char in[36], char out[36])
+{
+  return uuidv47_str_transform(ctx, in, out, 4, 7);
+}
+
+// Bulk newline-delimited text
+//
+// Transforms a buffer of '\n'-separated canonical UUID strings in one pass:
+// lines are parsed in groups of up to 64, run through the batch kernels while
+// still in cache, and formatted (lowercase) back to the same offsets. Output
+// is exactly as long as the input, so `out` may equal `in`. A line that is not
+// a 36-character canonical UUID of the input version (v7 to encode, v4 to
+// decode) is copied through unchanged and flagged in `err_bitmap` (bit i of
+// word i / 64 for the i-th line of this call).
+//
+// At most `max_lines` lines are handled; `err_bitmap` needs (max_lines + 63) / 64
+// words. Returns the number of bytes consumed (always whole lines, the last one
+// possibly without '\n'), and stores the number of lines in *n_lines. Call
+// again with the remainder to stream a larger buffer.
+static inline size_t uuidv47_transform_lines(const uuidv47_ctx_t *ctx, const char *in, size_t len, char *out,
+                                             uint64_t *err_bitmap, size_t max_lines, size_t *n_lines, int ver)
+{
+  uuid128_t ids[64];
+  size_t offs[64];
+  uuidv47_simd_level_t level = uuidv47_simd_level();
+  size_t pos = 0, line = 0;
+
+  while (pos < len && line < max_lines)
+  {
+    size_t group = max_lines - line < 64 ? max_lines - line : 64;
+    size_t n_ok = 0;
+    uint64_t bad = 0;
+    size_t g = 0;
+    for (; g < group && pos < len; g++)
+    {
+      size_t start = pos;
+      const char *nl = (const char *)memchr(in + pos, '\n', len - pos);
+      size_t end = nl ? (size_t)(nl - in) : len;
+      pos = end < len ? end + 1 : len;
+      if (end - start == 36 && uuid_parse(in + start, &ids[n_ok]) && uuid_version(&ids[n_ok]) == (ver == 4 ? 7 : 4))
+        offs[n_ok++] = start;
+      else
+      {
+        bad |= 1ULL << g;
+        memmove(out + start, in + start, end - start);
+      }
+      if (end < len)
+        out[end] = '\n';
+    }
+
+    uuidv47_transform_batch(ctx, ids, ids, n_ok, ver, level);
+    for (size_t k = 0; k < n_ok; k++)
+      uuid_format36(&ids[k], out + offs[k], false);
+
+    err_bitmap[line / 64] = bad; // every group but the last is 64 lines
+    line += g;
+  }
+  *n_lines = line;
+  return pos;
+}
+
+static inline size_t uuidv47_encode_lines(const uuidv47_ctx_t *ctx, const char *in, size_t len, char *out,
+                                          uint64_t *err_bitmap, size_t max_lines, size_t *n_lines)
+{
+  return uuidv47_transform_lines(ctx, in, len, out, err_bitmap, max_lines, n_lines, 4);
+}
+
+static inline size_t uuidv47_decode_lines(const uuidv47_ctx_t *ctx, const char *in, size_t len, char *out,
+                                          uint64_t *err_bitmap, size_t max_lines, size_t *n_lines)
+{
+  return uuidv47_transform_lines(ctx, in, len, out, err_bitmap, max_lines, n_lines, 7);
+}
+
+#if defined(UUIDV47_ENABLE_THREADS) && UUIDV47_ENABLE_THREADS
+// Parallel batch transform
+//
+// The array is cut into chunks of UUIDV47_PARALLEL_CHUNK IDs (in + out fit in
+// L2) and each worker starts on its own contiguous run of chunks. A worker that
+// runs dry steals single chunks from the back of the others' runs, so uneven
+// progress (frequency scaling, noisy neighbours) does not leave cores idle.
+// The calling thread is worker 0. A worker whose thread cannot be created
+// simply never runs, and its chunks are stolen by the others.
+//
+// There is no persistent pool: every call creates and joins its worker
+// threads, which costs tens of microseconds per thread. That is noise for
+// millions of IDs, but for small batches the single-threaded batch calls
+// win (one worker is used per UUIDV47_PARALLEL_CHUNK IDs at most).
+#ifndef UUIDV47_PARALLEL_CHUNK
+#define UUIDV47_PARALLEL_CHUNK 4096
+#endif
+#ifndef UUIDV47_MAX_THREADS
+#define UUIDV47_MAX_THREADS 256
+#endif
+
+typedef struct uuidv47_thread_stats
+{
+  size_t ids;     // IDs transformed by this worker
+  size_t chunks;  // chunks processed, own and stolen
+  size_t stolen;  // chunks taken from other workers (0 in NUMA mode)
+  uint64_t ns;    // wall time from start to running out of work
+  size_t remote;  // NUMA mode: chunks whose input lives on another node
+  unsigned node;  // NUMA mode: kernel node id the worker is pinned to
+} uuidv47_thread_stats_t;
+
+typedef struct uuidv47_par_slot
+{
+  UUIDV47_ALIGN(64) _Atomic uint64_t range; // remaining chunks [lo, hi): lo in the low 32 bits
+  struct uuidv47_par_job *job;
+  unsigned id;
+} uuidv47_par_slot_t;
+
+typedef struct uuidv47_par_job
+{
+  const uuidv47_ctx_t *ctx;
+  const uuid128_t *in;
+  uuid128_t *out;
+  size_t n;
+  int ver;
+  unsigned nthreads;
+  uuidv47_simd_level_t level;
+  uuidv47_par_slot_t *slots;
+  uuidv47_thread_stats_t *stats;
+} uuidv47_par_job_t;
+
+static inline uint64_t uuidv47_par_now_ns(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Owner takes from the front, thieves from the back; both by CAS on the packed pair.
+static inline int64_t uuidv47_par_take(uuidv47_par_slot_t *s, bool from_back)
+{
+  uint64_t r = atomic_load_explicit(&s->range, memory_order_relaxed);
+  for (;;)
+  {
+    uint64_t lo = r & 0xFFFFFFFFu, hi = r >> 32;
+    if (lo >= hi)
+      return -1;
+    uint64_t next = from_back ? (lo | ((hi - 1) << 32)) : ((lo + 1) | (hi << 32));
+    if (atomic_compare_exchange_weak_explicit(&s->range, &r, next, memory_order_relaxed, memory_order_relaxed))
+      return (int64_t)(from_back ? hi - 1 : lo);
+  }
+}
+
+static inline void *uuidv47_par_worker(void *arg)
+{
+  uuidv47_par_slot_t *self = (uuidv47_par_slot_t *)arg;
+  uuidv47_par_job_t *job = self->job;
+  uuidv47_thread_stats_t st = {0};
+  uint64_t t0 = uuidv47_par_now_ns();
+  unsigned victim = self->id;
+  for (;;)
+  {
+    int64_t c = uuidv47_par_take(self, false);
+    if (c < 0)
+    {
+      // own run is empty: scan the others once, starting after the last victim
+      for (unsigned k = 1; k < job->nthreads && c < 0; k++)
+      {
+        victim = (victim + 1) % job->nthreads;
+        if (victim != self->id)
+          c = uuidv47_par_take(&job->slots[victim], true);
+      }
+      if (c < 0)
+        break;
+      st.stolen++;
+    }
+    size_t first = (size_t)c * UUIDV47_PARALLEL_CHUNK;
+    size_t len = job->n - first < UUIDV47_PARALLEL_CHUNK ? job->n - first : UUIDV47_PARALLEL_CHUNK;
+    uuidv47_transform_batch(job->ctx, &job->in[first], &job->out[first], len, job->ver, job->level);
+    st.ids += len;
+    st.chunks++;
+  }
+  st.ns = uuidv47_par_now_ns() - t0;
+  if (job->stats)
+    job->stats[self->id] = st;
+  return NULL;
+}
+
+static inline unsigned uuidv47_transform_parallel(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                              size_t n, int ver, unsigned nthreads, uuidv47_thread_stats_t *stats)
+{
+  uuidv47_par_slot_t slots[UUIDV47_MAX_THREADS];
+  pthread_t tids[UUIDV47_MAX_THREADS];
+  bool started[UUIDV47_MAX_THREADS];
+  if (nthreads == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = online > 0 ? (unsigned)online : 1u;
+  }
+  if (nthreads > UUIDV47_MAX_THREADS)
+    nthreads = UUIDV47_MAX_THREADS;
+  size_t chunks = (n + UUIDV47_PARALLEL_CHUNK - 1) / UUIDV47_PARALLEL_CHUNK;
+  if (chunks > 0xFFFFFFFFu)
+    chunks = 0; // more than 2^32 chunks: fall back to one thread below
+  if (nthreads > chunks)
+    nthreads = chunks ? (unsigned)chunks : 1u;
+
+  uuidv47_par_job_t job = {ctx, in, out, n, ver, nthreads, uuidv47_simd_level(), slots, stats};
+  if (chunks == 0)
+  {
+    uint64_t t0 = uuidv47_par_now_ns();
+    uuidv47_transform_batch(ctx, in, out, n, ver, job.level);
+    if (stats)
+    {
+      uuidv47_thread_stats_t st = {.ids = n, .chunks = n ? 1u : 0u, .ns = uuidv47_par_now_ns() - t0};
+      stats[0] = st;
+    }
+    return 1;
+  }
+  for (unsigned t = 0; t < nthreads; t++)
+  {
+    uint64_t lo = chunks * t / nthreads, hi = chunks * (t + 1) / nthreads;
+    atomic_init(&slots[t].range, lo | (hi << 32));
+    slots[t].job = &job;
+    slots[t].id = t;
+    if (stats)
+    {
+      uuidv47_thread_stats_t zero = {0};
+      stats[t] = zero;
+    }
+  }
+  for (unsigned t = 1; t < nthreads; t++)
+    started[t] = pthread_create(&tids[t], NULL, uuidv47_par_worker, &slots[t]) == 0;
+  uuidv47_par_worker(&slots[0]);
+  for (unsigned t = 1; t < nthreads; t++)
+    if (started[t])
+      pthread_join(tids[t], NULL);
+  return nthreads;
+}
+
+// nthreads = 0 uses every online CPU. Fewer workers run when there are fewer
+// chunks than threads; the count used is returned, and stats (NULL, or room
+// for that many entries) receives per-worker counts and busy time.
+static inline unsigned uuidv47_ctx_encode_parallel(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                   size_t n, unsigned nthreads, uuidv47_thread_stats_t *stats)
+{
+  return uuidv47_transform_parallel(ctx, in, out, n, 4, nthreads, stats);
+}
+
+static inline unsigned uuidv47_ctx_decode_parallel(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                   size_t n, unsigned nthreads, uuidv47_thread_stats_t *stats)
+{
+  return uuidv47_transform_parallel(ctx, in, out, n, 7, nthreads, stats);
+}
+
+// Parallel sort
+//
+// The timestamp range, estimated from a sample, is cut into
+// UUIDV47_SORT_BUCKETS equal ordered buckets. Each worker counts its own slice
+// of the input by bucket, then moves it into scratch at offsets that keep
+// every bucket contiguous; finally workers claim buckets one at a time and
+// finish each with uuidv47_sort. IDs outside the sampled range go to the
+// first or last bucket, so the result is exact for any input and skew only
+// costs balance.
+#ifndef UUIDV47_SORT_BUCKETS
+#define UUIDV47_SORT_BUCKETS 4096
+#endif
+
+typedef struct uuidv47_sort_job
+{
+  uuid128_t *ids, *scratch;
+  size_t n;
+  unsigned nthreads;
+  int phase;     // 0: count, 1: scatter, 2: sort buckets
+  uint64_t lo;   // sampled minimum timestamp
+  unsigned shift;
+  size_t *counts; // per worker and bucket; after phase 0, write offsets
+  size_t *start;  // UUIDV47_SORT_BUCKETS + 1 bucket bounds
+  _Atomic size_t next;
+} uuidv47_sort_job_t;
+
+typedef struct uuidv47_sort_arg
+{
+  uuidv47_sort_job_t *job;
+  unsigned id;
+} uuidv47_sort_arg_t;
+
+static inline size_t uuidv47_sort_bucket(const uuidv47_sort_job_t *job, const uuid128_t *u)
+{
+  uint64_t ts = rd48be(u->b);
+  if (ts <= job->lo)
+    return 0;
+  uint64_t b = (ts - job->lo) >> job->shift;
+  return b < UUIDV47_SORT_BUCKETS ? (size_t)b : UUIDV47_SORT_BUCKETS - 1;
+}
+
+static inline void *uuidv47_sort_worker(void *arg)
+{
+  uuidv47_sort_arg_t *a = (uuidv47_sort_arg_t *)arg;
+  uuidv47_sort_job_t *job = a->job;
+  size_t first = job->n * a->id / job->nthreads, last = job->n * (a->id + 1) / job->nthreads;
+  size_t *c = &job->counts[(size_t)a->id * UUIDV47_SORT_BUCKETS];
+  if (job->phase == 0)
+    for (size_t i = first; i < last; i++)
+      c[uuidv47_sort_bucket(job, &job->ids[i])]++;
+  else if (job->phase == 1)
+    for (size_t i = first; i < last; i++)
+      job->scratch[c[uuidv47_sort_bucket(job, &job->ids[i])]++] = job->ids[i];
+  else
+    for (;;)
+    {
+      size_t b = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+      if (b >= UUIDV47_SORT_BUCKETS)
+        break;
+      size_t s = job->start[b], len = job->start[b + 1] - s;
+      if (len == 0)
+        continue;
+      memcpy(&job->ids[s], &job->scratch[s], len * sizeof(uuid128_t));
+      uuidv47_sort(&job->ids[s], len, &job->scratch[s]);
+    }
+  return NULL;
+}
+
+// Runs one phase on every worker. Phases 0 and 1 own fixed slices, so a
+// worker whose thread cannot be created runs on the calling thread instead.
+static inline void uuidv47_sort_phase(uuidv47_sort_job_t *job, int phase)
+{
+  uuidv47_sort_arg_t args[UUIDV47_MAX_THREADS];
+  pthread_t tids[UUIDV47_MAX_THREADS];
+  bool started[UUIDV47_MAX_THREADS];
+  job->phase = phase;
+  for (unsigned t = 0; t < job->nthreads; t++)
+  {
+    args[t].job = job;
+    args[t].id = t;
+  }
+  for (unsigned t = 1; t < job->nthreads; t++)
+    started[t] = pthread_create(&tids[t], NULL, uuidv47_sort_worker, &args[t]) == 0;
+  uuidv47_sort_worker(&args[0]);
+  for (unsigned t = 1; t < job->nthreads; t++)
+    if (started[t])
+      pthread_join(tids[t], NULL);
+    else if (phase < 2)
+      uuidv47_sort_worker(&args[t]);
+}
+
+// Same result as uuidv47_sort; scratch must have room for n IDs. nthreads = 0
+// uses every online CPU, and small arrays (or a failed allocation of the
+// per-worker counts) run single-threaded. Returns the worker count used.
+static inline unsigned uuidv47_sort_parallel(uuid128_t *ids, size_t n, uuid128_t *scratch, unsigned nthreads)
+{
+  if (nthreads == 0)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = online > 0 ? (unsigned)online : 1u;
+  }
+  if (nthreads > UUIDV47_MAX_THREADS)
+    nthreads = UUIDV47_MAX_THREADS;
+  if (nthreads > n / UUIDV47_PARALLEL_CHUNK)
+    nthreads = n / UUIDV47_PARALLEL_CHUNK ? (unsigned)(n / UUIDV47_PARALLEL_CHUNK) : 1u;
+  size_t *mem = nthreads > 1 ? (size_t *)calloc((size_t)(nthreads + 1) * UUIDV47_SORT_BUCKETS + 1, sizeof(size_t))
+                             : NULL;
+  if (mem == NULL)
+  {
+    uuidv47_sort(ids, n, scratch);
+    return 1;
+  }
+
+  uuidv47_sort_job_t job = {.ids = ids, .scratch = scratch, .n = n, .nthreads = nthreads, .lo = UINT64_MAX,
+                            .counts = mem, .start = mem + (size_t)nthreads * UUIDV47_SORT_BUCKETS};
+  uint64_t hi = 0;
+  for (size_t i = 0, step = n / 1024 ? n / 1024 : 1; i < n; i += step)
+  {
+    uint64_t ts = rd48be(ids[i].b);
+    job.lo = ts < job.lo ? ts : job.lo;
+    hi = ts > hi ? ts : hi;
+  }
+  unsigned bits = 0, bucket_bits = 0;
+  while (bits < 64 && ((hi - job.lo) >> bits) != 0)
+    bits++;
+  while ((1u << bucket_bits) < UUIDV47_SORT_BUCKETS)
+    bucket_bits++;
+  job.shift = bits > bucket_bits ? bits - bucket_bits : 0;
+
+  uuidv47_sort_phase(&job, 0);
+  size_t off = 0;
+  for (size_t b = 0; b < UUIDV47_SORT_BUCKETS; b++)
+  {
+    job.start[b] = off;
+    for (unsigned t = 0; t < nthreads; t++)
+    {
+      size_t k = job.counts[(size_t)t * UUIDV47_SORT_BUCKETS + b];
+      job.counts[(size_t)t * UUIDV47_SORT_BUCKETS + b] = off;
+      off += k;
+    }
+  }
+  job.start[UUIDV47_SORT_BUCKETS] = off;
+  uuidv47_sort_phase(&job, 1);
+  atomic_init(&job.next, 0);
+  uuidv47_sort_phase(&job, 2);
+  free(mem);
+  return nthreads;
+}
+
+#if UUIDV47_NUMA
+// NUMA-aware parallel transform
+//
+// Chunks are grouped by the node that holds their input pages (one
+// move_pages query per 256 chunks), and each node gets its own workers,
+// pinned to that node's CPUs. Workers drain their node's chunks first and only
+// then help other nodes; chunks processed from another node are counted as
+// remote. A node's workers share one queue, so nothing counts as stolen.
+// uuidv47_numa_place binds a buffer to a node with mbind, for callers
+// that cannot rely on first-touch placement.
+#ifndef UUIDV47_NUMA_MAX_NODES
+#define UUIDV47_NUMA_MAX_NODES 16
+#endif
+
+typedef struct uuidv47_numa_topology
+{
+  unsigned nodes;                         // nodes with CPUs, numbered 0..nodes-1 here
+  unsigned id[UUIDV47_NUMA_MAX_NODES];    // kernel node number of each
+  cpu_set_t cpus[UUIDV47_NUMA_MAX_NODES];
+  unsigned ncpus[UUIDV47_NUMA_MAX_NODES];
+} uuidv47_numa_topology_t;
+
+// Reads /sys/devices/system/node; without it, reports one node with the
+// process's current CPUs.
+static inline void uuidv47_numa_topology(uuidv47_numa_topology_t *topo)
+{
+  topo->nodes = 0;
+  for (unsigned node = 0; node < UUIDV47_NUMA_MAX_NODES; node++)
+  {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+    FILE *f = fopen(path, "r");
+    if (!f)
+      continue;
+    cpu_set_t *set = &topo->cpus[topo->nodes];
+    CPU_ZERO(set);
+    unsigned lo, hi;
+    int c;
+    while (fscanf(f, "%u", &lo) == 1)
+    {
+      hi = lo;
+      if ((c = fgetc(f)) == '-')
+      {
+        if (fscanf(f, "%u", &hi) != 1)
+          break;
+        c = fgetc(f);
+      }
+      for (unsigned cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++)
+        CPU_SET(cpu, set);
+      if (c != ',')
+        break;
+    }
+    fclose(f);
+    unsigned count = (unsigned)CPU_COUNT(set);
+    if (count) // memory-only nodes have no workers to place
+    {
+      topo->id[topo->nodes] = node;
+      topo->ncpus[topo->nodes] = count;
+      topo->nodes++;
+    }
+  }
+  if (topo->nodes == 0)
+  {
+    topo->nodes = 1;
+    topo->id[0] = 0;
+    CPU_ZERO(&topo->cpus[0]);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &topo->cpus[0]) != 0)
+      CPU_SET(0, &topo->cpus[0]);
+    topo->ncpus[0] = (unsigned)CPU_COUNT(&topo->cpus[0]);
+  }
+}
+
+// Binds [buf, buf + bytes) to kernel node number node (topology id[]); pages
+// already touched are migrated.
+// Returns false for node >= UUIDV47_NUMA_MAX_NODES or if the kernel refuses,
+// e.g. no NUMA support.
+static inline bool uuidv47_numa_place(void *buf, size_t bytes, unsigned node)
+{
+  if (node >= UUIDV47_NUMA_MAX_NODES)
+    return false;
+  const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t)buf & ~(page - 1);
+  uintptr_t end = ((uintptr_t)buf + bytes + page - 1) & ~(page - 1);
+  unsigned long mask[UUIDV47_NUMA_MAX_NODES / (8 * sizeof(unsigned long)) + 1] = {0};
+  mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+  const int mpol_bind = 2;
+  const unsigned mpol_mf_move = 1u << 1;
+  return syscall(SYS_mbind, (void *)start, (unsigned long)(end - start), mpol_bind, mask,
+                 (unsigned long)(8 * sizeof(mask)), mpol_mf_move) == 0;
+}
+
+typedef struct uuidv47_numa_job
+{
+  uuidv47_par_job_t base;
+  const uuidv47_numa_topology_t *topo;
+  const uint32_t *order;                         // chunk indices grouped by node
+  size_t begin[UUIDV47_NUMA_MAX_NODES + 1];      // node k owns order[begin[k]..begin[k + 1])
+  _Atomic size_t cursor[UUIDV47_NUMA_MAX_NODES]; // next position in node k's group
+} uuidv47_numa_job_t;
+
+typedef struct uuidv47_numa_worker_arg
+{
+  uuidv47_numa_job_t *job;
+  unsigned id, node;
+} uuidv47_numa_worker_arg_t;
+
+static inline void *uuidv47_numa_worker(void *arg)
+{
+  uuidv47_numa_worker_arg_t *self = (uuidv47_numa_worker_arg_t *)arg;
+  uuidv47_numa_job_t *job = self->job;
+  const uuidv47_par_job_t *b = &job->base;
+  unsigned nodes = job->topo->nodes;
+  uuidv47_thread_stats_t st = {.node = job->topo->id[self->node]};
+  sched_setaffinity(0, sizeof(cpu_set_t), &job->topo->cpus[self->node]);
+  uint64_t t0 = uuidv47_par_now_ns();
+  for (unsigned k = 0; k < nodes; k++)
+  {
+    unsigned node = (self->node + k) % nodes;
+    for (;;)
+    {
+      size_t pos = atomic_fetch_add_explicit(&job->cursor[node], 1, memory_order_relaxed);
+      if (pos >= job->begin[node + 1] - job->begin[node])
+        break;
+      size_t first = (size_t)job->order[job->begin[node] + pos] * UUIDV47_PARALLEL_CHUNK;
+      size_t len = b->n - first < UUIDV47_PARALLEL_CHUNK ? b->n - first : UUIDV47_PARALLEL_CHUNK;
+      uuidv47_transform_batch(b->ctx, &b->in[first], &b->out[first], len, b->ver, b->level);
+      st.ids += len;
+      st.chunks++;
+      st.remote += (k != 0);
+    }
+  }
+  st.ns = uuidv47_par_now_ns() - t0;
+  if (b->stats)
+    b->stats[self->id] = st;
+  return NULL;
+}
+
+// threads_per_node = 0 uses every CPU of each node. Workers are numbered node
+// by node; the count is returned and stats (NULL or room for that many) gets
+// one entry per worker. Like uuidv47_transform_parallel, an empty input
+// reports one worker. Falls back to uuidv47_transform_parallel when the chunk
+// map cannot be allocated.
+static inline unsigned uuidv47_transform_parallel_numa(const uuidv47_ctx_t *ctx, const uuid128_t *in,
+                                                       uuid128_t *out, size_t n, int ver,
+                                                       unsigned threads_per_node, uuidv47_thread_stats_t *stats)
+{
+  if (n == 0)
+    return uuidv47_transform_parallel(ctx, in, out, 0, ver, 1, stats);
+  uuidv47_numa_topology_t topo;
+  uuidv47_numa_topology(&topo);
+  size_t chunks = (n + UUIDV47_PARALLEL_CHUNK - 1) / UUIDV47_PARALLEL_CHUNK;
+  uint32_t *order = chunks <= 0xFFFFFFFFu ? (uint32_t *)malloc(chunks * sizeof(uint32_t) + 1) : NULL;
+  uint8_t *owner = order ? (uint8_t *)malloc(chunks + 1) : NULL;
+  if (!owner)
+  {
+    free(order);
+    return uuidv47_transform_parallel(ctx, in, out, n, ver, threads_per_node * topo.nodes, stats);
+  }
+
+  // owning node of each chunk's first input page; pages not faulted in yet,
+  // memory-only nodes and kernels without NUMA support all count as node 0
+  size_t count[UUIDV47_NUMA_MAX_NODES] = {0};
+  for (size_t c0 = 0; c0 < chunks; c0 += 256)
+  {
+    void *pages[256];
+    int status[256];
+    unsigned long m = (unsigned long)(chunks - c0 < 256 ? chunks - c0 : 256);
+    for (unsigned long j = 0; j < m; j++)
+    {
+      pages[j] = (void *)(uintptr_t)&in[(c0 + j) * UUIDV47_PARALLEL_CHUNK];
+      status[j] = -1;
+    }
+    if (topo.nodes > 1)
+      syscall(SYS_move_pages, 0, m, pages, NULL, status, 0);
+    for (unsigned long j = 0; j < m; j++)
+    {
+      unsigned node = 0;
+      for (unsigned k = 0; status[j] >= 0 && k < topo.nodes; k++)
+        if ((unsigned)status[j] == topo.id[k])
+          node = k;
+      owner[c0 + j] = (uint8_t)node;
+      count[node]++;
+    }
+  }
+
+  uuidv47_numa_job_t job;
+  job.base = (uuidv47_par_job_t){ctx, in, out, n, ver, 0, uuidv47_simd_level(), NULL, stats};
+  job.topo = &topo;
+  job.order = order;
+  job.begin[0] = 0;
+  for (unsigned k = 0; k < topo.nodes; k++)
+  {
+    job.begin[k + 1] = job.begin[k] + count[k];
+    atomic_init(&job.cursor[k], 0);
+  }
+  size_t fill[UUIDV47_NUMA_MAX_NODES];
+  memcpy(fill, job.begin, sizeof(fill));
+  for (size_t c = 0; c < chunks; c++)
+    order[fill[owner[c]]++] = (uint32_t)c;
+  free(owner);
+
+  uuidv47_numa_worker_arg_t args[UUIDV47_MAX_THREADS];
+  pthread_t tids[UUIDV47_MAX_THREADS];
+  unsigned nworkers = 0;
+  for (unsigned k = 0; k < topo.nodes; k++)
+  {
+    unsigned per = threads_per_node ? threads_per_node : topo.ncpus[k];
+    for (unsigned t = 0; t < per && nworkers < UUIDV47_MAX_THREADS && nworkers < chunks; t++)
+    {
+      args[nworkers].job = &job;
+      args[nworkers].id = nworkers;
+      args[nworkers].node = k;
+      if (stats)
+      {
+        uuidv47_thread_stats_t zero = {.node = topo.id[k]};
+        stats[nworkers] = zero;
+      }
+      nworkers++;
+    }
+  }
+  // the caller's own affinity is left alone: every worker is a fresh thread
+  unsigned started = 0;
+  for (unsigned w = 0; w < nworkers; w++)
+  {
+    if (pthread_create(&tids[w], NULL, uuidv47_numa_worker, &args[w]) != 0)
+      break;
+    started++;
+  }
+  for (unsigned w = 0; w < started; w++)
+    pthread_join(tids[w], NULL);
+  if (started == 0 && chunks)
+  {
+    // no threads at all: do the work here, unpinned
+    uuidv47_transform_batch(ctx, in, out, n, ver, job.base.level);
+    if (stats)
+    {
+      uuidv47_thread_stats_t st = {.ids = n, .chunks = chunks};
+      stats[0] = st;
+    }
+    nworkers = 1;
+  }
+  free(order);
+  return started ? started : nworkers;
+}
+
+static inline unsigned uuidv47_ctx_encode_parallel_numa(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                        size_t n, unsigned threads_per_node,
+                                                        uuidv47_thread_stats_t *stats)
+{
+  return uuidv47_transform_parallel_numa(ctx, in, out, n, 4, threads_per_node, stats);
+}
+
+static inline unsigned uuidv47_ctx_decode_parallel_numa(const uuidv47_ctx_t *ctx, const uuid128_t *in, uuid128_t *out,
+                                                        size_t n, unsigned threads_per_node,
+                                                        uuidv47_thread_stats_t *stats)
+{
+  return uuidv47_transform_parallel_numa(ctx, in, out, n, 7, threads_per_node, stats);
+}
+#endif // UUIDV47_NUMA
+#endif // UUIDV47_ENABLE_THREADS
+
+#if UUIDV47_MMAP
+// Sorted ID index file
+//
+// A snapshot of IDs in uuidv47_sort order, read through mmap: opening reads
+// the header and the (small) seconds table, and queries read only the record
+// pages they touch. Layout (integers little-endian):
+//
+//   0   header, 64 bytes:
+//       0  magic "UUIDV47I"       8  u32 format version (1)   12 u32 reserved (0)
+//       16 u64 record count n     24 u64 second count m
+//       32 u64 records offset     40 u64 seconds offset
+//       48 u64 min timestamp (ms) 56 u64 max timestamp (ms)
+//   64  n records, 16 bytes each: the IDs as stored in memory
+//   ... m second entries, 16 bytes each: u64 second (timestamp / 1000), u64
+//       index of its first record; one per second that has records
+//
+// A lookup finds the key's second in the sparse seconds table (far smaller
+// than the records) and then searches only that second's records.
+#define UUIDV47_IDXFILE_MAGIC "UUIDV47I"
+#define UUIDV47_IDXFILE_VERSION 1u
+#define UUIDV47_IDXFILE_HEADER 64u
+
+typedef struct uuidv47_idxfile
+{
+  const uint8_t *map;
+  size_t map_len;
+  const uuid128_t *ids; // n records, sorted
+  size_t n;
+  const uint8_t *secs;  // m entries of 16 bytes
+  size_t nsec;
+  uint64_t ts_min, ts_max;
+} uuidv47_idxfile_t;
+
+// Writes sorted ids[0..n) to path (replacing it). Returns false, leaving no
+// file behind, if the IDs are not sorted or on any I/O error. Write to a
+// temporary name and rename() it over the live file to swap snapshots safely.
+static inline bool uuidv47_idxfile_write(const char *path, const uuid128_t *ids, size_t n)
+{
+  for (size_t i = 1; i < n; i++)
+    if (uuidv47_cmp(&ids[i - 1], &ids[i]) > 0)
+      return false;
+  FILE *fp = fopen(path, "wb");
+  if (fp == NULL)
+    return false;
+  uint8_t hdr[UUIDV47_IDXFILE_HEADER] = {0};
+  bool ok = fwrite(hdr, 1, sizeof hdr, fp) == sizeof hdr && (n == 0 || fwrite(ids, sizeof *ids, n, fp) == n);
+  uint64_t m = 0;
+  for (size_t i = 0; ok && i < n; i++)
+  {
+    uint64_t sec = rd48be(ids[i].b) / 1000;
+    if (i == 0 || sec != rd48be(ids[i - 1].b) / 1000)
+    {
+      uint8_t e[16];
+      wr64le(e, sec);
+      wr64le(&e[8], i);
+      ok = fwrite(e, 1, sizeof e, fp) == sizeof e;
+      m++;
+    }
+  }
+  memcpy(hdr, UUIDV47_IDXFILE_MAGIC, 8);
+  hdr[8] = UUIDV47_IDXFILE_VERSION;
+  wr64le(&hdr[16], n);
+  wr64le(&hdr[24], m);
+  wr64le(&hdr[32], UUIDV47_IDXFILE_HEADER);
+  wr64le(&hdr[40], UUIDV47_IDXFILE_HEADER + (uint64_t)n * 16);
+  wr64le(&hdr[48], n ? rd48be(ids[0].b) : 0);
+  wr64le(&hdr[56], n ? rd48be(ids[n - 1].b) : 0);
+  ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(hdr, 1, sizeof hdr, fp) == sizeof hdr;
+  ok = fclose(fp) == 0 && ok;
+  if (!ok)
+    remove(path);
+  return ok;
+}
+
+// Maps path read-only, checks the header against the file size and walks the
+// seconds table once (first record index 0, seconds and record indices
+// strictly increasing, indices below n), so queries on a corrupt file cannot index
+// outside the mapping. On failure returns false and leaves nothing to close.
+static inline bool uuidv47_idxfile_open(uuidv47_idxfile_t *f, const char *path)
+{
+  memset(f, 0, sizeof *f);
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  void *map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)UUIDV47_IDXFILE_HEADER)
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping keeps the file alive
+  if (map == MAP_FAILED)
+    return false;
+  const uint8_t *h = (const uint8_t *)map;
+  uint64_t len = (uint64_t)st.st_size, n = rd64le(&h[16]), m = rd64le(&h[24]);
+  bool ok = memcmp(h, UUIDV47_IDXFILE_MAGIC, 8) == 0 && rd64le(&h[8]) == UUIDV47_IDXFILE_VERSION &&
+            rd64le(&h[32]) == UUIDV47_IDXFILE_HEADER && n <= (len - UUIDV47_IDXFILE_HEADER) / 16 &&
+            rd64le(&h[40]) == UUIDV47_IDXFILE_HEADER + n * 16 && m <= n &&
+            len == UUIDV47_IDXFILE_HEADER + n * 16 + m * 16 && (m == 0) == (n == 0);
+  const uint8_t *secs = &h[UUIDV47_IDXFILE_HEADER + (ok ? n * 16 : 0)];
+  for (uint64_t j = 0; ok && j < m; j++)
+  {
+    uint64_t first = rd64le(&secs[j * 16 + 8]);
+    if (j == 0)
+      ok = first == 0;
+    else
+      ok = first < n && rd64le(&secs[j * 16]) > rd64le(&secs[(j - 1) * 16]) &&
+           first > rd64le(&secs[(j - 1) * 16 + 8]);
+  }
+  if (!ok)
+  {
+    munmap(map, (size_t)len);
+    return false;
+  }
+  f->map = h;
+  f->map_len = (size_t)len;
+  f->ids = (const uuid128_t *)(const void *)&h[UUIDV47_IDXFILE_HEADER];
+  f->n = (size_t)n;
+  f->secs = secs;
+  f->nsec = (size_t)m;
+  f->ts_min = rd64le(&h[48]);
+  f->ts_max = rd64le(&h[56]);
+  return true;
+}
+
+static inline void uuidv47_idxfile_close(uuidv47_idxfile_t *f)
+{
+  if (f->map)
+    munmap((void *)(uintptr_t)f->map, f->map_len);
+  memset(f, 0, sizeof *f);
+}
+
+static inline uint64_t uuidv47_idxfile_sec(const uuidv47_idxfile_t *f, size_t i)
+{
+  return rd64le(&f->secs[i * 16]);
+}
+
+// First second entry >= sec, or nsec. Entries are unique and usually close to
+// evenly spaced, so the interpolated guess is normally exact and the gallop
+// around it only confirms it.
+static inline size_t uuidv47_idxfile_sec_lower_bound(const uuidv47_idxfile_t *f, uint64_t sec)
+{
+  size_t m = f->nsec, lo, hi, step = 1;
+  if (m == 0 || sec <= uuidv47_idxfile_sec(f, 0))
+    return 0;
+  uint64_t a = uuidv47_idxfile_sec(f, 0), b = uuidv47_idxfile_sec(f, m - 1);
+  if (sec > b)
+    return m;
+  size_t g = (size_t)((double)(sec - a) / (double)(b - a) * (double)(m - 1));
+  if (uuidv47_idxfile_sec(f, g) < sec)
+  {
+    for (lo = g + 1; lo + step - 1 < m && uuidv47_idxfile_sec(f, lo + step - 1) < sec; step *= 2)
+      lo += step;
+    hi = lo + step - 1 < m ? lo + step - 1 : m;
+  }
+  else
+  {
+    for (hi = g; hi >= step && uuidv47_idxfile_sec(f, hi - step) >= sec; step *= 2)
+      hi -= step;
+    lo = hi >= step ? hi - step + 1 : 0;
+  }
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (uuidv47_idxfile_sec(f, mid) < sec)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// First record >= key, or n.
+static inline size_t uuidv47_idxfile_lower_bound(const uuidv47_idxfile_t *f, const uuid128_t *key)
+{
+  uint64_t sec = rd48be(key->b) / 1000;
+  size_t lo = uuidv47_idxfile_sec_lower_bound(f, sec);
+  if (lo == f->nsec)
+    return f->n;
+  size_t first = (size_t)rd64le(&f->secs[lo * 16 + 8]);
+  if (uuidv47_idxfile_sec(f, lo) != sec)
+    return first; // no records in that second: everything from here on is larger
+  size_t end = lo + 1 < f->nsec ? (size_t)rd64le(&f->secs[(lo + 1) * 16 + 8]) : f->n;
+  return uuidv47_binary_lower_bound(f->ids, first, end, key);
+}
+
+static inline bool uuidv47_idxfile_find(const uuidv47_idxfile_t *f, const uuid128_t *key, size_t *pos)
+{
+  size_t i = uuidv47_idxfile_lower_bound(f, key);
+  if (i == f->n || uuidv47_cmp(&f->ids[i], key) != 0)
+    return false;
+  if (pos)
+    *pos = i;
+  return true;
+}
+
+// Records with t0 <= timestamp < t1 are f->ids[*first .. *first + count); returns count.
+static inline size_t uuidv47_idxfile_time_range(const uuidv47_idxfile_t *f, uint64_t t0, uint64_t t1, size_t *first)
+{
+  const uint64_t max48 = 0x0001000000000000ULL;
+  uuid128_t k0 = {{0}}, k1 = {{0}};
+  size_t lo = f->n, hi = f->n;
+  if (t0 < max48)
+  {
+    wr48be(k0.b, t0);
+    lo = uuidv47_idxfile_lower_bound(f, &k0);
+  }
+  if (t1 < max48)
+  {
+    wr48be(k1.b, t1);
+    hi = uuidv47_idxfile_lower_bound(f, &k1);
+  }
+  *first = lo;
+  return hi > lo ? hi - lo : 0;
 }
+#endif // UUIDV47_MMAP
 
 #endif // UUIDV47_H